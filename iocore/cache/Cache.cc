@@ -2166,7 +2166,7 @@ CacheVC::is_pread_capable()
 
 #define STORE_COLLISION 1
 
-static void
+void
 unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay)
 {
   char *tmp = doc->hdr();
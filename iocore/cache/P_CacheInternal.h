@@ -531,6 +531,7 @@ extern CacheSync *cacheDirSync;
 // Function Prototypes
 int cache_write(CacheVC *, CacheHTTPInfoVector *);
 int get_alternate_index(CacheHTTPInfoVector *cache_vector, CacheKey key);
+void unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay);
 CacheVC *new_DocEvacuator(int nbytes, Vol *d);
 
 // inline Functions
@@ -27,6 +27,7 @@
 #include "P_Cache.h"
 #include "I_Tasks.h"
 #include "ts/fastlz.h"
+#include "ts/Regression.h"
 #ifdef HAVE_ZLIB_H
 #include <zlib.h>
 #endif
@@ -98,6 +99,7 @@ struct RamCacheCLFUS : public RamCache {
   void resize_hashtable();
   void victimize(RamCacheCLFUSEntry *e);
   void move_compressed(RamCacheCLFUSEntry *e);
+  void unmarshal_copy(RamCacheCLFUSEntry *e);
   RamCacheCLFUSEntry *destroy(RamCacheCLFUSEntry *e);
   void requeue_victims(Que(RamCacheCLFUSEntry, lru_link) & victims);
   void tick(); // move CLOCK on history
@@ -525,6 +527,7 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
         e->flag_bits.incompressible = true;
       }
       if (l > REQUIRED_SHRINK * e->size) {
+        unmarshal_copy(e);
         goto Lfailed;
       }
       if (l < e->len) {
@@ -550,6 +553,9 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
       }
       e->data            = new_xmalloc_IOBufferData(bb, l);
       e->data->_mem_type = DEFAULT_ALLOC;
+      if (!e->flag_bits.compressed) {
+        unmarshal_copy(e);
+      }
       check_accounting(this);
     }
     goto Lcontinue;
@@ -569,6 +575,24 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
   return;
 }
 
+// A copy-in-copy-out entry keeps the headers of its document marshaled
+// so that it can still be compressed, and every hit copies it and fixes
+// the headers up again.  Once it is kept uncompressed, fix them up here,
+// under the volume lock, and hand out the buffer itself like any other.
+void
+RamCacheCLFUS::unmarshal_copy(RamCacheCLFUSEntry *e)
+{
+  if (!e->flag_bits.copy) {
+    return;
+  }
+  int okay = 1;
+  unmarshal_helper(reinterpret_cast<Doc *>(e->data->data()), e->data, okay);
+  if (okay) {
+    e->flag_bits.copy = 0;
+  }
+  DDebug("ram_cache", "unmarshal %X %d %d %d", e->key.slice32(3), e->auxkey1, e->auxkey2, okay);
+}
+
 void RamCacheCLFUS::requeue_victims(Que(RamCacheCLFUSEntry, lru_link) & victims)
 {
   RamCacheCLFUSEntry *victim = nullptr;
@@ -782,3 +806,138 @@ new_RamCacheCLFUS()
   RamCacheCLFUS *r = new RamCacheCLFUS;
   return r;
 }
+
+#if TS_HAS_TESTS
+
+// Builds a Doc holding the marshaled headers of one alternate and @a payload_len bytes that do not compress.
+static Ptr<IOBufferData>
+make_http_doc(int payload_len)
+{
+  static const char req_str[]  = "GET http://www.example.com/ram HTTP/1.1\r\nHost: www.example.com\r\n\r\n";
+  static const char resp_str[] = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n\r\n";
+  HTTPParser parser;
+  HTTPHdr req, resp;
+  const char *start;
+
+  http_parser_init(&parser);
+  start = req_str;
+  req.create(HTTP_TYPE_REQUEST);
+  req.parse_req(&parser, &start, req_str + sizeof(req_str) - 1, true);
+  http_parser_clear(&parser);
+  start = resp_str;
+  resp.create(HTTP_TYPE_RESPONSE);
+  resp.parse_resp(&parser, &start, resp_str + sizeof(resp_str) - 1, true);
+  http_parser_clear(&parser);
+
+  CacheHTTPInfo info;
+  CacheHTTPInfoVector vector;
+  info.create();
+  info.request_set(&req);
+  info.response_set(&resp);
+  vector.insert(&info);
+  req.destroy();
+  resp.destroy();
+
+  int hlen = vector.marshal_length();
+  int len  = sizeof(Doc) + hlen + payload_len;
+  Ptr<IOBufferData> data(new_IOBufferData(iobuffer_size_to_index(len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED));
+  Doc *doc = reinterpret_cast<Doc *>(data->data());
+  memset(static_cast<void *>(doc), 0, sizeof(Doc));
+  doc->magic     = DOC_MAGIC;
+  doc->len       = len;
+  doc->total_len = payload_len;
+  doc->hlen      = vector.marshal(doc->hdr(), hlen);
+  doc->doc_type  = CACHE_FRAG_TYPE_HTTP;
+  doc->v_major   = CACHE_DB_MAJOR_VERSION;
+  doc->v_minor   = CACHE_DB_MINOR_VERSION;
+  srand48(7);
+  for (char *p = doc->data(); p < doc->data() + payload_len; ++p) {
+    *p = lrand48();
+  }
+  vector.clear();
+  return data;
+}
+
+// An HTTP Doc stored copy-in-copy-out that the compressor keeps uncompressed is fixed up once and then shared.
+REGRESSION_TEST(ram_cache_CLFUS_copy)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+
+  int saved_compress         = cache_config_ram_cache_compress;
+  int saved_compress_percent = cache_config_ram_cache_compress_percent;
+  CacheKey vol_key;
+  Vol *vol                   = theCache->key_to_vol(&vol_key, "example.com", sizeof("example.com") - 1);
+  RamCacheCLFUS *cache       = new RamCacheCLFUS;
+  Ptr<IOBufferData> doc_data = make_http_doc(8192);
+  Ptr<IOBufferData> hit1, hit2;
+  INK_MD5 key;
+  *pstatus = REGRESSION_TEST_PASSED;
+
+  key.u64[0] = 0x1234;
+  key.u64[1] = 0x5678;
+  cache->init(1 << 20, vol);
+  cache->put(&key, doc_data.get(), reinterpret_cast<Doc *>(doc_data->data())->len, true);
+  cache->get(&key, &hit1);
+  cache->get(&key, &hit2);
+  if (!hit1 || hit1 == hit2) {
+    rprintf(t, "copied entry hands out its own buffer\n");
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  cache_config_ram_cache_compress         = CACHE_COMPRESSION_FASTLZ;
+  cache_config_ram_cache_compress_percent = 100;
+  cache->compress_entries(this_ethread());
+  cache_config_ram_cache_compress         = saved_compress;
+  cache_config_ram_cache_compress_percent = saved_compress_percent;
+
+  RamCacheCLFUSEntry *e = cache->bucket[key.slice32(3) % cache->nbuckets].head;
+  if (!e || e->flag_bits.copy || !e->flag_bits.incompressible || e->flag_bits.compressed) {
+    rprintf(t, "entry copy %d incompressible %d compressed %d, expected 0 1 0\n", e ? e->flag_bits.copy : -1,
+            e ? e->flag_bits.incompressible : -1, e ? e->flag_bits.compressed : -1);
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  hit1 = nullptr;
+  hit2 = nullptr;
+  cache->get(&key, &hit1);
+  cache->get(&key, &hit2);
+  if (!hit1 || hit1 != hit2) {
+    rprintf(t, "hits on the uncompressed entry do not share its buffer\n");
+    *pstatus = REGRESSION_TEST_FAILED;
+  } else {
+    Doc *doc = reinterpret_cast<Doc *>(hit1->data());
+    CacheHTTPInfoVector vector;
+    int length;
+    if (vector.get_handles(doc->hdr(), doc->hlen, hit1.get()) != doc->hlen || vector.count() != 1) {
+      rprintf(t, "the shared buffer holds %d alternates\n", vector.count());
+      *pstatus = REGRESSION_TEST_FAILED;
+    } else {
+      CacheHTTPInfo *alt = vector.get(0);
+      const char *host   = alt->request_get()->host_get(&length);
+      if (alt->response_get()->status_get() != HTTP_STATUS_OK || !host || length != 15 ||
+          memcmp(host, "www.example.com", 15) != 0) {
+        rprintf(t, "the alternate in the shared buffer is unusable\n");
+        *pstatus = REGRESSION_TEST_FAILED;
+      }
+    }
+    vector.clear(false);
+  }
+  Doc *stored = reinterpret_cast<Doc *>(doc_data->data());
+  if (hit1 && memcmp(reinterpret_cast<Doc *>(hit1->data())->data(), stored->data(), 8192) != 0) {
+    rprintf(t, "the payload of the shared buffer changed\n");
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  hit1 = nullptr;
+  hit2 = nullptr;
+  cache->destroy(cache->bucket[key.slice32(3) % cache->nbuckets].head);
+  ats_free(cache->bucket);
+  ats_free(cache->seen);
+  delete cache;
+}
+
+#endif /* TS_HAS_TESTS */
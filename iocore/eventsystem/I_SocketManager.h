@@ -84,6 +84,10 @@ struct SocketManager {
 
   int recv(int s, void *buf, int len, int flags);
   int recvfrom(int fd, void *buf, int size, int flags, struct sockaddr *addr, socklen_t *addrlen);
+#if HAVE_RECVMMSG
+  // result is the number of messages or -errno
+  int recvmmsg(int fd, struct mmsghdr *msgvec, int vlen, int flags, struct timespec *timeout = nullptr);
+#endif
 
   int64_t write(int fd, void *buf, int len, void *pOLP = nullptr);
   int64_t writev(int fd, struct iovec *vector, size_t count);
@@ -93,6 +97,14 @@ struct SocketManager {
   int send(int fd, void *buf, int len, int flags);
   int sendto(int fd, void *buf, int len, int flags, struct sockaddr const *to, int tolen);
   int sendmsg(int fd, struct msghdr *m, int flags, void *pOLP = nullptr);
+#if HAVE_SENDMMSG
+  // result is the number of messages or -errno
+  int sendmmsg(int fd, struct mmsghdr *msgvec, int vlen, int flags);
+#endif
+#if HAVE_SPLICE
+  // result is the number of bytes moved or -errno
+  int64_t splice(int fd_in, int fd_out, int64_t len, unsigned int flags);
+#endif
   int64_t lseek(int fd, off_t offset, int whence);
   int fstat(int fd, struct stat *);
   int unlink(char *buf);
@@ -177,6 +177,20 @@ SocketManager::recvfrom(int fd, void *buf, int size, int flags, struct sockaddr
   return r;
 }
 
+#if HAVE_RECVMMSG
+TS_INLINE int
+SocketManager::recvmmsg(int fd, struct mmsghdr *msgvec, int vlen, int flags, struct timespec *timeout)
+{
+  int r;
+  do {
+    r = ::recvmmsg(fd, msgvec, vlen, flags, timeout);
+    if (unlikely(r < 0))
+      r = -errno;
+  } while (r == -EINTR);
+  return r;
+}
+#endif
+
 TS_INLINE int64_t
 SocketManager::write(int fd, void *buf, int size, void * /* pOLP ATS_UNUSED */)
 {
@@ -251,6 +265,32 @@ SocketManager::sendmsg(int fd, struct msghdr *m, int flags, void * /* pOLP ATS_U
   return r;
 }
 
+#if HAVE_SENDMMSG
+TS_INLINE int
+SocketManager::sendmmsg(int fd, struct mmsghdr *msgvec, int vlen, int flags)
+{
+  int r;
+  do {
+    if (unlikely((r = ::sendmmsg(fd, msgvec, vlen, flags)) < 0))
+      r = -errno;
+  } while (r == -EINTR);
+  return r;
+}
+#endif
+
+#if HAVE_SPLICE
+TS_INLINE int64_t
+SocketManager::splice(int fd_in, int fd_out, int64_t len, unsigned int flags)
+{
+  int64_t r;
+  do {
+    if (unlikely((r = ::splice(fd_in, nullptr, fd_out, nullptr, len, flags)) < 0))
+      r = -errno;
+  } while (r == -EINTR);
+  return r;
+}
+#endif
+
 TS_INLINE int64_t
 SocketManager::lseek(int fd, off_t offset, int whence)
 {
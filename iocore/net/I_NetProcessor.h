@@ -88,6 +88,16 @@ public:
 
     int tfo_queue_length;
 
+    /// Maximum open connections from a single client address.
+    /// 0 => no limit.
+    int client_max_connections;
+    /// Maximum new connections per second from a single client address.
+    /// 0 => no limit.
+    int client_connection_rate;
+    /// New connections from a single client accepted back to back before the rate applies.
+    /// 0 => one second's worth of @c client_connection_rate.
+    int client_connection_burst;
+
     /** Transparency on client (user agent) connection.
         @internal This is irrelevant at a socket level (since inbound
         transparency must be set up when the listen socket is created)
@@ -169,6 +169,8 @@ struct NetVCOptions {
   static uint32_t const SOCK_OPT_LINGER_ON = 4;
   /// Value for TCP Fast open @c sockopt_flags
   static uint32_t const SOCK_OPT_TCP_FAST_OPEN = 8;
+  /// Value for zero copy (MSG_ZEROCOPY) sends @c sockopt_flags
+  static uint32_t const SOCK_OPT_ZERO_COPY = 16;
 
   uint32_t packet_mark;
   uint32_t packet_tos;
@@ -509,6 +511,20 @@ public:
    */
   virtual void trapWriteBufferEmpty(int event = VC_EVENT_WRITE_READY);
 
+  /** Have the kernel move the bytes read on this connection straight to @a dst.
+
+      While the buffer of the read VIO is empty, bytes read from this
+      connection are spliced into a pipe and written from there to @a dst
+      without being copied into user space. The read VIO of this connection
+      and the write VIO of @a dst account for them as usual, so the caller
+      must not need to see the data. This lasts until the next do_io_read()
+      on this connection or do_io_write() on @a dst.
+
+      @return @c true if splicing was set up, @c false if either connection
+      does not support it.
+   */
+  virtual bool splice_to(NetVConnection *dst);
+
   /** Returns local sockaddr storage. */
   sockaddr const *get_local_addr();
 
@@ -681,4 +697,10 @@ NetVConnection::trapWriteBufferEmpty(int event)
   write_buffer_empty_event = event;
 }
 
+inline bool
+NetVConnection::splice_to(NetVConnection *dst ATS_UNUSED)
+{
+  return false;
+}
+
 #endif
@@ -39,6 +39,7 @@ int net_event_period        = 10;
 int net_accept_period       = 10;
 int net_retry_delay         = 10;
 int net_throttle_delay      = 50; /* milliseconds */
+int net_zerocopy_min_write  = 16384;
 
 static inline void
 configure_net()
@@ -48,6 +49,7 @@ configure_net()
 
   REC_EstablishStaticConfigInt32(net_retry_delay, "proxy.config.net.retry_delay");
   REC_EstablishStaticConfigInt32(net_throttle_delay, "proxy.config.net.throttle_delay");
+  REC_EstablishStaticConfigInt32(net_zerocopy_min_write, "proxy.config.net.zerocopy_min_write_size");
 
   // These are not reloadable
   REC_ReadConfigInteger(net_event_period, "proxy.config.net.event_period");
@@ -67,11 +69,20 @@ register_net_stats()
     {"proxy.process.net.calls_to_writetonet", net_calls_to_writetonet_stat},
     {"proxy.process.net.calls_to_writetonet_afterpoll", net_calls_to_writetonet_afterpoll_stat},
     {"proxy.process.net.inactivity_cop_lock_acquire_failure", inactivity_cop_lock_acquire_failure_stat},
+    {"proxy.process.net.inactivity_cop.runs", inactivity_cop_runs_stat},
+    {"proxy.process.net.inactivity_cop.checked", inactivity_cop_checked_stat},
+    {"proxy.process.net.inactivity_cop.expired", inactivity_cop_expired_stat},
+    {"proxy.process.net.inactivity_cop.runtime", inactivity_cop_runtime_stat},
+    {"proxy.process.net.per_client.connections_throttled_in", net_client_connections_throttled_stat},
     {"proxy.process.net.net_handler_run", net_handler_run_stat},
     {"proxy.process.net.read_bytes", net_read_bytes_stat},
     {"proxy.process.net.write_bytes", net_write_bytes_stat},
     {"proxy.process.net.fastopen_out.attempts", net_fastopen_attempts_stat},
     {"proxy.process.net.fastopen_out.successes", net_fastopen_successes_stat},
+    {"proxy.process.net.zerocopy.writes", net_zerocopy_writes_stat},
+    {"proxy.process.net.zerocopy.bytes", net_zerocopy_bytes_stat},
+    {"proxy.process.net.zerocopy.copied", net_zerocopy_copied_stat},
+    {"proxy.process.net.spliced_bytes", net_spliced_bytes_stat},
     {"proxy.process.socks.connections_successful", socks_connections_successful_stat},
     {"proxy.process.socks.connections_unsuccessful", socks_connections_unsuccessful_stat},
   };
@@ -0,0 +1,163 @@
+/** @file
+
+  Per client address admission control for accepted connections.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_NetClientLimiter.h"
+#include "ts/Regression.h"
+#include "ts/TestBox.h"
+
+NetClientLimiter::NetClientLimiter(int max_conn, int rate, int burst)
+  : max_connections(max_conn > 0 ? max_conn : 0),
+    interval(rate > 0 ? HRTIME_SECOND / rate : 0),
+    tolerance(rate > 0 ? (HRTIME_SECOND / rate) * ((burst > 0 ? burst : rate) - 1) : 0)
+{
+  for (int i = 0; i < DEPTH; ++i) {
+    for (int j = 0; j < WIDTH; ++j) {
+      _count[i][j].store(0, std::memory_order_relaxed);
+      _tat[i][j].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+void
+NetClientLimiter::_cells(sockaddr const *addr, uint32_t idx[DEPTH]) const
+{
+  uint64_t key = 0;
+
+  if (ats_is_ip4(addr)) {
+    key = ats_ip4_addr_cast(addr);
+  } else if (ats_is_ip6(addr)) {
+    memcpy(&key, ats_ip_addr8_cast(addr), sizeof(key)); // the /64 prefix
+  }
+
+  // 64 bit finalizer from MurmurHash3, each row takes 16 bits of the result.
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+
+  for (int i = 0; i < DEPTH; ++i) {
+    idx[i] = (key >> (16 * i)) & (WIDTH - 1);
+  }
+}
+
+bool
+NetClientLimiter::admit(sockaddr const *addr, ink_hrtime now)
+{
+  uint32_t idx[DEPTH];
+
+  _cells(addr, idx);
+
+  if (max_connections && connections(addr) >= max_connections) {
+    return false;
+  }
+
+  if (interval) {
+    // Generic cell rate algorithm, the single timestamp form of a token bucket.
+    ink_hrtime tat = _tat[0][idx[0]].load(std::memory_order_relaxed);
+    for (int i = 1; i < DEPTH; ++i) {
+      tat = std::min(tat, _tat[i][idx[i]].load(std::memory_order_relaxed));
+    }
+    if (tat - now > tolerance) {
+      return false;
+    }
+    for (int i = 0; i < DEPTH; ++i) {
+      std::atomic<ink_hrtime> &cell = _tat[i][idx[i]];
+      ink_hrtime expected           = cell.load(std::memory_order_relaxed);
+      while (!cell.compare_exchange_weak(expected, std::max(expected, now) + interval, std::memory_order_relaxed)) {
+        ;
+      }
+    }
+  }
+
+  if (max_connections) {
+    for (int i = 0; i < DEPTH; ++i) {
+      _count[i][idx[i]].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  return true;
+}
+
+void
+NetClientLimiter::release(sockaddr const *addr)
+{
+  uint32_t idx[DEPTH];
+
+  _cells(addr, idx);
+  for (int i = 0; i < DEPTH; ++i) {
+    _count[i][idx[i]].fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+int
+NetClientLimiter::connections(sockaddr const *addr) const
+{
+  uint32_t idx[DEPTH];
+  int32_t zret;
+
+  _cells(addr, idx);
+  zret = _count[0][idx[0]].load(std::memory_order_relaxed);
+  for (int i = 1; i < DEPTH; ++i) {
+    zret = std::min(zret, _count[i][idx[i]].load(std::memory_order_relaxed));
+  }
+
+  return zret;
+}
+
+REGRESSION_TEST(NetClientLimiter)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  IpEndpoint a, b, c;
+  ink_hrtime now = HRTIME_SECONDS(1000);
+
+  box = REGRESSION_TEST_PASSED;
+
+  ats_ip_pton("192.0.2.1", &a);
+  ats_ip_pton("192.0.2.2", &b);
+  ats_ip_pton("2001:db8::1", &c);
+
+  Ptr<NetClientLimiter> conns = make_ptr(new NetClientLimiter(2, 0, 0));
+  box.check(conns->admit(&a.sa, now), "first connection admitted");
+  box.check(conns->admit(&a.sa, now), "second connection admitted");
+  box.check(!conns->admit(&a.sa, now), "third connection refused");
+  box.check(conns->admit(&b.sa, now), "other client admitted");
+  conns->release(&a.sa);
+  box.check(conns->connections(&a.sa) == 1, "release drops the count");
+  box.check(conns->admit(&a.sa, now), "connection admitted after a release");
+
+  ats_ip_pton("2001:db8::2", &a);
+  box.check(conns->admit(&c.sa, now) && conns->admit(&c.sa, now), "IPv6 connections admitted");
+  box.check(!conns->admit(&a.sa, now), "IPv6 clients in the same /64 share the limit");
+
+  Ptr<NetClientLimiter> rate = make_ptr(new NetClientLimiter(0, 10, 3));
+  ats_ip_pton("192.0.2.1", &a);
+  for (int i = 0; i < 3; ++i) {
+    box.check(rate->admit(&a.sa, now), "burst connection %d admitted", i);
+  }
+  box.check(!rate->admit(&a.sa, now), "connection over the burst refused");
+  box.check(rate->admit(&b.sa, now), "other client not rate limited");
+  box.check(rate->admit(&a.sa, now + HRTIME_MSECONDS(100)), "connection admitted once a token is earned");
+  box.check(!rate->admit(&a.sa, now + HRTIME_MSECONDS(100)), "only one token earned");
+  box.check(rate->connections(&a.sa) == 0, "rate limiter does not count connections");
+}
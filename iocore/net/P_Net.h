@@ -56,6 +56,15 @@ enum Net_Stats {
   net_fastopen_attempts_stat,
   net_fastopen_successes_stat,
   net_tcp_accept_stat,
+  net_zerocopy_writes_stat,
+  net_zerocopy_bytes_stat,
+  net_zerocopy_copied_stat,
+  net_spliced_bytes_stat,
+  inactivity_cop_runs_stat,
+  inactivity_cop_checked_stat,
+  inactivity_cop_expired_stat,
+  inactivity_cop_runtime_stat,
+  net_client_connections_throttled_stat,
   Net_Stat_Count
 };
 
@@ -41,6 +41,7 @@
 
 #include "ts/ink_platform.h"
 #include "P_Connection.h"
+#include "P_NetClientLimiter.h"
 
 struct NetAccept;
 class Event;
@@ -92,6 +93,8 @@ struct NetAccept : public Continuation {
 
   HttpProxyPort *proxyPort = nullptr;
   NetProcessor::AcceptOptions opt;
+  /// Per client limits, shared by the clones of this accept. nullptr if no limit is set.
+  Ptr<NetClientLimiter> client_limiter;
 
   virtual NetProcessor *getNetProcessor() const;
 
@@ -104,6 +107,11 @@ struct NetAccept : public Continuation {
   int do_listen(bool non_blocking);
   int do_blocking_accept(EThread *t);
 
+  /// Apply the per client limits to @a con. @return @c false if it is over a limit and was closed.
+  bool admit_client(Connection &con);
+  /// Charge the connection of an admitted client to @a vc, or release it if @a vc is @c nullptr.
+  void charge_client(UnixNetVConnection *vc, Connection &con);
+
   virtual int acceptEvent(int event, void *e);
   virtual int acceptFastEvent(int event, void *e);
   int acceptLoopEvent(int event, Event *e);
@@ -0,0 +1,74 @@
+/** @file
+
+  Per client address admission control for accepted connections.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#ifndef __P_NETCLIENTLIMITER_H__
+#define __P_NETCLIENTLIMITER_H__
+
+#include <atomic>
+
+#include "ts/ink_platform.h"
+#include "ts/ink_hrtime.h"
+#include "ts/ink_inet.h"
+#include "ts/Ptr.h"
+
+/**
+  Limits the number of open connections and the rate of new connections per client address.
+
+  Clients are not tracked individually. The connection counts and the token buckets live in
+  count-min sketches indexed by the client address, so the memory used is fixed no matter how
+  many clients connect. A client is charged with the least loaded of its cells, so a collision
+  can only make a limit stricter, never looser. IPv6 clients are keyed by their /64 prefix.
+
+  Every cell is an atomic, accept and net threads update the sketches without taking a lock.
+  Concurrent accepts from the same client can overshoot a limit by the number of threads.
+ */
+struct NetClientLimiter : public RefCountObj {
+  static const int DEPTH = 4;    ///< Number of hash rows.
+  static const int WIDTH = 4096; ///< Cells per row, must be a power of 2.
+
+  /**
+    @a max_connections open connections per client, 0 for no limit.
+    @a rate new connections per second per client, 0 for no limit.
+    @a burst new connections accepted back to back before @a rate applies, 0 for @a rate.
+   */
+  NetClientLimiter(int max_connections, int rate, int burst);
+
+  /// Charge a new connection from @a addr. @return @c false if it is over a limit and must be closed.
+  bool admit(sockaddr const *addr, ink_hrtime now);
+  /// Release a connection that was admitted while @c max_connections was set.
+  void release(sockaddr const *addr);
+  /// Estimated number of open connections from @a addr.
+  int connections(sockaddr const *addr) const;
+
+  const int max_connections;
+  const ink_hrtime interval;  ///< Time to earn back one connection, 0 if the rate is not limited.
+  const ink_hrtime tolerance; ///< How far a bucket may run ahead of the clock.
+
+private:
+  void _cells(sockaddr const *addr, uint32_t idx[DEPTH]) const;
+
+  std::atomic<int32_t> _count[DEPTH][WIDTH];
+  std::atomic<ink_hrtime> _tat[DEPTH][WIDTH]; ///< Theoretical arrival time of the next connection.
+};
+
+#endif
@@ -130,6 +130,13 @@ public:
   void net_read_io(NetHandler *nh, EThread *lthread) override;
   int64_t load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs) override;
   void registerNextProtocolSet(SSLNextProtocolSet *);
+
+  bool
+  splice_to(NetVConnection *dst ATS_UNUSED) override
+  {
+    // TLS records are decrypted in user space, there is nothing to splice.
+    return false;
+  }
   void do_io_close(int lerrno = -1) override;
 
   ////////////////////////////////////////////////////////////
@@ -53,6 +53,13 @@ struct UDPNetProcessorInternal : public UDPNetProcessor {
 
 extern UDPNetProcessorInternal udpNetInternal;
 
+// Number of datagrams moved per recvmmsg/sendmmsg call, and the largest
+// datagram the batched read path will accept.
+#define UDP_READ_BATCH_SIZE 16
+#define UDP_READ_BUFFER_SIZE 65536
+#define UDP_SEND_BATCH_SIZE 32
+#define UDP_SEND_MAX_IOV 8
+
 // 20 ms slots; 2048 slots  => 40 sec. into the future
 #define SLOT_TIME_MSEC 20
 #define SLOT_TIME HRTIME_MSECONDS(SLOT_TIME_MSEC)
@@ -292,6 +299,7 @@ public:
 
   void SendPackets();
   void SendUDPPacket(UDPPacketInternal *p, int32_t pktLen);
+  void SendMultipleUDPPackets(UDPPacketInternal **p, int n);
 
   // Interface exported to the outside world
   void send(UDPPacket *p);
@@ -319,6 +327,8 @@ public:
   Event *trigger_event = nullptr;
   ink_hrtime nextCheck;
   ink_hrtime lastCheck;
+  // scratch space for batched reads, allocated on first use
+  char *read_buffer = nullptr;
 
   int startNetEvent(int event, Event *data);
   int mainNetEvent(int event, Event *data);
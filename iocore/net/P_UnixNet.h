@@ -36,6 +36,9 @@
 #define EVENTIO_UDP_CONNECTION 4
 #define EVENTIO_ASYNC_SIGNAL 5
 
+// How long a closed socket may wait for its zero copy sends to complete.
+#define ZEROCOPY_LINGER_TIMEOUT HRTIME_SECONDS(30)
+
 #if TS_USE_EPOLL
 #ifdef USE_EDGE_TRIGGER_EPOLL
 #define USE_EDGE_TRIGGER 1
@@ -230,13 +233,19 @@ public:
   QueM(UnixNetVConnection, NetState, read, ready_link) read_ready_list;
   QueM(UnixNetVConnection, NetState, write, ready_link) write_ready_list;
   Que(UnixNetVConnection, link) open_list;
-  DList(UnixNetVConnection, cop_link) cop_list;
+  // InactivityCop timing wheel with one slot per second. A NetVC is filed under the second of its
+  // earliest deadline, and only refiled when the cop reaches it and finds the deadline has moved out.
+  static const int COP_WHEEL_SLOTS = 64;
+  DList(UnixNetVConnection, cop_link) cop_wheel[COP_WHEEL_SLOTS];
+  ASLL(UnixNetVConnection, cop_resched_link) cop_resched_list;
+  int64_t cop_last_sec = 0; // last wheel second processed by the InactivityCop
   ASLLM(UnixNetVConnection, NetState, read, enable_link) read_enable_list;
   ASLLM(UnixNetVConnection, NetState, write, enable_link) write_enable_list;
   Que(UnixNetVConnection, keep_alive_queue_link) keep_alive_queue;
   uint32_t keep_alive_queue_size;
   Que(UnixNetVConnection, active_queue_link) active_queue;
   uint32_t active_queue_size;
+  Que(ZeroCopyLinger, link) zerocopy_linger_list;
   uint32_t max_connections_per_thread_in;
   uint32_t max_connections_active_per_thread_in;
 
@@ -283,7 +292,7 @@ public:
 
   /**
     Start to handle active timeout and inactivity timeout on a UnixNetVConnection.
-    Put the netvc into open_list. All NetVCs in the open_list is checked for timeout by InactivityCop.
+    Put the netvc into open_list and the InactivityCop wheel, which checks it for timeout.
     Only be called when holding the mutex of this NetHandler and must call startIO(netvc) first.
 
     @param netvc UnixNetVConnection to be managed by InactivityCop
@@ -291,7 +300,7 @@ public:
   void startCop(UnixNetVConnection *netvc);
   /**
     Stop to handle active timeout and inactivity on a UnixNetVConnection.
-    Remove the netvc from open_list and cop_list.
+    Remove the netvc from open_list and the InactivityCop wheel.
     Also remove the netvc from keep_alive_queue and active_queue if its context is IN.
     Only be called when holding the mutex of this NetHandler.
 
@@ -299,6 +308,19 @@ public:
    */
   void stopCop(UnixNetVConnection *netvc);
 
+  /**
+    File @a netvc in the InactivityCop wheel under its current deadline.
+    Only be called when holding the mutex of this NetHandler.
+   */
+  void cop_schedule(UnixNetVConnection *netvc);
+  /**
+    Make sure the InactivityCop visits @a netvc no later than its current deadline. Cheap when the
+    deadline moved out, which is the common case. May be called from any thread holding the netvc mutex.
+   */
+  void update_cop_deadline(UnixNetVConnection *netvc);
+  /// File NetVCs whose deadline was moved in by other threads.
+  void process_cop_resched_list();
+
   // Signal the epoll_wait to terminate.
   void signalActivity();
 
@@ -309,9 +331,21 @@ public:
    */
   void free_netvc(UnixNetVConnection *netvc);
 
+  /**
+    Keep a closed socket open until the kernel completes its zero copy sends.
+    Takes ownership of @a fd and of the sends in @a pending.
+   */
+  void linger_zerocopy(int fd, Queue<ZeroCopySend> &pending);
+  /// Reap completions for lingering sockets and close the ones that are done.
+  void reap_zerocopy_linger();
+
   NetHandler();
 
 private:
+  friend class InactivityCop;
+
+  ink_hrtime _cop_deadline(UnixNetVConnection *netvc);
+  void _cop_unschedule(UnixNetVConnection *netvc);
   void _close_vc(UnixNetVConnection *vc, ink_hrtime now, int &handle_event, int &closed, int &total_idle_time,
                  int &total_idle_count);
 };
@@ -794,6 +828,7 @@ NetHandler::startCop(UnixNetVConnection *netvc)
   ink_assert(!open_list.in(netvc));
 
   open_list.enqueue(netvc);
+  cop_schedule(netvc);
 }
 
 TS_INLINE void
@@ -802,9 +837,83 @@ NetHandler::stopCop(UnixNetVConnection *netvc)
   ink_release_assert(netvc->nh == this);
 
   open_list.remove(netvc);
-  cop_list.remove(netvc);
+  _cop_unschedule(netvc);
+  if (netvc->in_cop_resched_list) {
+    cop_resched_list.remove(netvc);
+    netvc->in_cop_resched_list = 0;
+  }
   remove_from_keep_alive_queue(netvc);
   remove_from_active_queue(netvc);
 }
 
+/// Earliest timeout the InactivityCop has to act on, 0 if there is none.
+TS_INLINE ink_hrtime
+NetHandler::_cop_deadline(UnixNetVConnection *netvc)
+{
+  if (netvc->closed) {
+    return Thread::get_hrtime(); // closed off thread, the cop frees it
+  }
+
+  ink_hrtime at = netvc->next_inactivity_timeout_at;
+  // Active timeouts are only enforced for connections in the active queue.
+  if (netvc->active_timeout_in && netvc->next_activity_timeout_at && (!at || netvc->next_activity_timeout_at < at) &&
+      active_queue.in(netvc)) {
+    at = netvc->next_activity_timeout_at;
+  }
+  return at;
+}
+
+TS_INLINE void
+NetHandler::_cop_unschedule(UnixNetVConnection *netvc)
+{
+  if (netvc->cop_filed_at) {
+    cop_wheel[ink_hrtime_to_sec(netvc->cop_filed_at) % COP_WHEEL_SLOTS].remove(netvc);
+    netvc->cop_filed_at = 0;
+  }
+}
+
+TS_INLINE void
+NetHandler::cop_schedule(UnixNetVConnection *netvc)
+{
+  _cop_unschedule(netvc);
+
+  ink_hrtime at = _cop_deadline(netvc);
+  if (!at || !open_list.in(netvc)) {
+    // Nothing to time out, update_cop_deadline() files it once a deadline is set.
+    return;
+  }
+
+  // Deadlines beyond the wheel are parked in its last slot and refiled from there. That is the slot
+  // before cop_last_sec, cop_last_sec itself may be the slot the cop is emptying.
+  int64_t sec = std::min(std::max(ink_hrtime_to_sec(at), cop_last_sec + 1), cop_last_sec + COP_WHEEL_SLOTS - 1);
+
+  netvc->cop_filed_at = HRTIME_SECONDS(sec);
+  cop_wheel[sec % COP_WHEEL_SLOTS].push(netvc);
+}
+
+TS_INLINE void
+NetHandler::update_cop_deadline(UnixNetVConnection *netvc)
+{
+  ink_hrtime at = _cop_deadline(netvc);
+  if (!at || (netvc->cop_filed_at && netvc->cop_filed_at <= at)) {
+    return;
+  }
+
+  if (mutex->thread_holding == this_ethread()) {
+    cop_schedule(netvc);
+  } else if (!ink_atomic_swap(&netvc->in_cop_resched_list, 1)) {
+    cop_resched_list.push(netvc);
+  }
+}
+
+TS_INLINE void
+NetHandler::process_cop_resched_list()
+{
+  SList(UnixNetVConnection, cop_resched_link) rq(cop_resched_list.popall());
+  while (UnixNetVConnection *vc = rq.pop()) {
+    vc->in_cop_resched_list = 0;
+    cop_schedule(vc);
+  }
+}
+
 #endif
@@ -99,6 +99,65 @@ struct OOB_callback : public Continuation {
   }
 };
 
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#define TS_HAS_ZEROCOPY 1
+#else
+#define TS_HAS_ZEROCOPY 0
+#endif
+
+/** Buffer data handed to the kernel by a @c MSG_ZEROCOPY send.
+
+    The kernel transmits straight from these pages, so the blocks are
+    held until the error queue reports the send complete.
+*/
+struct ZeroCopySend {
+  uint32_t seq = 0;          ///< Kernel sequence number of the send.
+  bool done    = false;      ///< Completion seen, waiting on older sends.
+  Ptr<IOBufferBlock> blocks; ///< Clone of the bytes that were sent.
+
+  LINK(ZeroCopySend, link);
+};
+
+extern ClassAllocator<ZeroCopySend> zeroCopySendAllocator;
+
+/** Socket of a closed connection that still has zero copy sends in flight.
+
+    Closing the socket right away would let the pinned buffers be reused
+    while the kernel may still retransmit from them.
+*/
+struct ZeroCopyLinger {
+  int fd               = NO_FD;
+  ink_hrtime expire_at = 0;
+  Queue<ZeroCopySend> pending;
+
+  LINK(ZeroCopyLinger, link);
+};
+
+/// Release the sends in @a pending completed according to the error queue of @a fd.
+void zerocopy_reap(int fd, Queue<ZeroCopySend> &pending, EThread *thread);
+/// Release all of @a pending without waiting for completion.
+void zerocopy_release(Queue<ZeroCopySend> &pending);
+
+/** Kernel pipe that carries bytes from one socket to another with splice(2).
+
+    The reading connection fills the pipe from its socket and the writing
+    connection drains it into its own, so the bytes never reach user space.
+    Both connections hold a reference since either may close first.
+*/
+struct NetSplicePipe : public RefCountObj {
+  int fds[2]       = {NO_FD, NO_FD};
+  int64_t size     = 0; ///< Capacity of the pipe.
+  int64_t occupied = 0; ///< Bytes in the pipe.
+
+  bool open();
+  /// Move up to @a len bytes from @a fd into the pipe. @return bytes moved or -errno.
+  int64_t fill(int fd, int64_t len);
+  /// Move up to @a len bytes from the pipe to @a fd. @return bytes moved or -errno.
+  int64_t drain(int fd, int64_t len);
+
+  ~NetSplicePipe() override;
+};
+
 enum tcp_congestion_control_t { CLIENT_SIDE, SERVER_SIDE };
 
 class UnixNetVConnection : public NetVConnection
@@ -234,11 +293,14 @@ public:
   SLINKM(UnixNetVConnection, write, enable_link)
   LINK(UnixNetVConnection, keep_alive_queue_link);
   LINK(UnixNetVConnection, active_queue_link);
+  SLINK(UnixNetVConnection, cop_resched_link);
 
   ink_hrtime inactivity_timeout_in;
   ink_hrtime active_timeout_in;
   ink_hrtime next_inactivity_timeout_at;
   ink_hrtime next_activity_timeout_at;
+  ink_hrtime cop_filed_at; // wheel second the InactivityCop will visit this at, 0 if not filed
+  int in_cop_resched_list;
 
   EventIO ep;
   NetHandler *nh;
@@ -260,12 +322,26 @@ public:
   OOB_callback *oob_ptr;
   bool from_accept_thread;
   NetAccept *accept_object;
+  /// Per client limiter this connection is counted against, released when the VC is cleared.
+  Ptr<NetClientLimiter> client_limiter;
 
   // es - origin_trace associated connections
   bool origin_trace;
   const sockaddr *origin_trace_addr;
   int origin_trace_port;
 
+  /// @c MSG_ZEROCOPY sends not yet completed by the kernel, oldest first.
+  Queue<ZeroCopySend> zerocopy_pending;
+  /// Sequence number the kernel will assign to the next zero copy send.
+  uint32_t zerocopy_seq;
+  /// @c SO_ZEROCOPY is set on the socket.
+  bool zerocopy_enabled;
+
+  /// Pipe that bytes read from this connection are spliced into, see @c splice_to.
+  Ptr<NetSplicePipe> splice_in;
+  /// Pipe with bytes to send ahead of new data in the write VIO buffer.
+  Ptr<NetSplicePipe> splice_out;
+
   int startEvent(int event, Event *e);
   int acceptEvent(int event, Event *e);
   int mainEvent(int event, Event *e);
@@ -288,6 +364,23 @@ public:
   int set_tcp_congestion_control(int side) override;
   void apply_options() override;
 
+  bool splice_to(NetVConnection *dst) override;
+
+  /// Bytes ready to send, in the write VIO buffer @a buf or else in the splice pipe.
+  int64_t
+  write_avail_in(MIOBufferAccessor &buf)
+  {
+    int64_t avail = buf.reader()->read_avail();
+    if (avail == 0 && splice_out) {
+      avail = splice_out->occupied;
+    }
+    return avail;
+  }
+
+#if TS_HAS_ZEROCOPY
+  void zerocopy_pin(IOBufferReader *reader, int64_t len);
+#endif
+
   friend void write_to_net_io(NetHandler *, UnixNetVConnection *, EThread *);
 
   void
@@ -341,14 +434,6 @@ UnixNetVConnection::get_inactivity_timeout()
   return inactivity_timeout_in;
 }
 
-TS_INLINE void
-UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
-{
-  Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
-  active_timeout_in        = timeout_in;
-  next_activity_timeout_at = Thread::get_hrtime() + timeout_in;
-}
-
 TS_INLINE void
 UnixNetVConnection::cancel_inactivity_timeout()
 {
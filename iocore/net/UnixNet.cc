@@ -36,7 +36,7 @@ extern "C" void fd_reify(struct ev_loop *);
 
 // INKqa10496
 // One Inactivity cop runs on each thread once every second and
-// loops through the list of NetVCs and calls the timeouts
+// calls the timeouts of the NetVCs whose deadline has passed
 class InactivityCop : public Continuation
 {
 public:
@@ -45,54 +45,77 @@ public:
   check_inactivity(int event, Event *e)
   {
     (void)event;
-    ink_hrtime now = Thread::get_hrtime();
-    NetHandler &nh = *get_NetHandler(this_ethread());
+    ink_hrtime start = Thread::get_hrtime_updated();
+    ink_hrtime now   = Thread::get_hrtime();
+    NetHandler &nh   = *get_NetHandler(this_ethread());
+    int64_t now_sec  = ink_hrtime_to_sec(now);
+    int64_t checked  = 0;
+    int64_t expired  = 0;
 
     Debug("inactivity_cop_check", "Checking inactivity on Thread-ID #%d", this_ethread()->id);
-    // The rest NetVCs in cop_list which are not triggered between InactivityCop runs.
-    // Use pop() to catch any closes caused by callbacks.
-    while (UnixNetVConnection *vc = nh.cop_list.pop()) {
-      // If we cannot get the lock don't stop just keep cleaning
-      MUTEX_TRY_LOCK(lock, vc->mutex, this_ethread());
-      if (!lock.is_locked()) {
-        NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
-        continue;
-      }
+    nh.process_cop_resched_list();
 
-      if (vc->closed) {
-        nh.free_netvc(vc);
-        continue;
-      }
+    // Each wheel slot is visited once, even if the cop fell behind or the clock stepped.
+    if (now_sec < nh.cop_last_sec || now_sec - nh.cop_last_sec > NetHandler::COP_WHEEL_SLOTS) {
+      nh.cop_last_sec = now_sec - NetHandler::COP_WHEEL_SLOTS;
+    }
 
-      if (vc->next_inactivity_timeout_at && vc->next_inactivity_timeout_at < now) {
-        if (nh.keep_alive_queue.in(vc)) {
-          // only stat if the connection is in keep-alive, there can be other inactivity timeouts
-          ink_hrtime diff = (now - (vc->next_inactivity_timeout_at - vc->inactivity_timeout_in)) / HRTIME_SECOND;
-          NET_SUM_DYN_STAT(keep_alive_queue_timeout_total_stat, diff);
-          NET_INCREMENT_DYN_STAT(keep_alive_queue_timeout_count_stat);
+    while (nh.cop_last_sec < now_sec) {
+      ++nh.cop_last_sec;
+      // Use pop() to catch any closes caused by callbacks. NetVCs refiled while the slot
+      // is processed land in a later second.
+      while (UnixNetVConnection *vc = nh.cop_wheel[nh.cop_last_sec % NetHandler::COP_WHEEL_SLOTS].pop()) {
+        vc->cop_filed_at = 0;
+        ++checked;
+
+        // If we cannot get the lock don't stop just keep cleaning
+        MUTEX_TRY_LOCK(lock, vc->mutex, this_ethread());
+        if (!lock.is_locked()) {
+          NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
+          nh.cop_schedule(vc);
+          continue;
+        }
+
+        if (vc->closed) {
+          nh.free_netvc(vc);
+          continue;
+        }
+
+        if (vc->next_inactivity_timeout_at && vc->next_inactivity_timeout_at < now) {
+          if (nh.keep_alive_queue.in(vc)) {
+            // only stat if the connection is in keep-alive, there can be other inactivity timeouts
+            ink_hrtime diff = (now - (vc->next_inactivity_timeout_at - vc->inactivity_timeout_in)) / HRTIME_SECOND;
+            NET_SUM_DYN_STAT(keep_alive_queue_timeout_total_stat, diff);
+            NET_INCREMENT_DYN_STAT(keep_alive_queue_timeout_count_stat);
+          }
+          Debug("inactivity_cop_verbose", "vc: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, vc,
+                ink_hrtime_to_sec(now), vc->next_inactivity_timeout_at, vc->inactivity_timeout_in);
+          ++expired;
+          // mainEvent() returns EVENT_CONT without touching the NetVC when one of its
+          // try-locks fails. It is off the wheel by now, so refile it or the timeout is lost.
+          if (vc->handleEvent(EVENT_IMMEDIATE, e) == EVENT_CONT && !vc->closed && !vc->cop_filed_at &&
+              vc->next_inactivity_timeout_at && vc->next_inactivity_timeout_at < now) {
+            nh.cop_schedule(vc);
+          }
+        } else if (vc->active_timeout_in && vc->next_activity_timeout_at <= now && nh.active_queue.in(vc)) {
+          // close any connections over the active timeout
+          int handle_event = 0, closed = 0, total_idle_time = 0, total_idle_count = 0;
+          ++expired;
+          nh._close_vc(vc, now, handle_event, closed, total_idle_time, total_idle_count);
+        } else {
+          nh.cop_schedule(vc);
         }
-        Debug("inactivity_cop_verbose", "vc: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, vc,
-              ink_hrtime_to_sec(now), vc->next_inactivity_timeout_at, vc->inactivity_timeout_in);
-        vc->handleEvent(EVENT_IMMEDIATE, e);
-      }
-    }
-    // The cop_list is empty now.
-    // Let's reload the cop_list from open_list again.
-    forl_LL(UnixNetVConnection, vc, nh.open_list)
-    {
-      if (vc->thread == this_ethread()) {
-        nh.cop_list.push(vc);
       }
     }
-    // NetHandler will remove NetVC from cop_list if it is triggered.
-    // As the NetHandler runs, the number of NetVCs in the cop_list is decreasing.
-    // NetHandler runs 100 times maximum between InactivityCop runs.
-    // Therefore we don't have to check all the NetVCs as much as open_list.
 
-    // Cleanup the active and keep-alive queues periodically
-    nh.manage_active_queue(true); // close any connections over the active timeout
+    // Enforce the connection limits, this only walks the keep-alive queue when over the limit.
     nh.manage_keep_alive_queue();
 
+    NET_INCREMENT_DYN_STAT(inactivity_cop_runs_stat);
+    NET_SUM_DYN_STAT(inactivity_cop_checked_stat, checked);
+    NET_SUM_DYN_STAT(inactivity_cop_expired_stat, expired);
+    NET_SUM_DYN_STAT(inactivity_cop_runtime_stat, ink_hrtime_to_usec(Thread::get_hrtime_updated() - start));
+
     return 0;
   }
 };
@@ -215,6 +238,8 @@ initialize_thread_for_net(EThread *thread)
   PollCont *pc       = get_PollCont(thread);
   PollDescriptor *pd = pc->pollDescriptor;
 
+  nh->cop_last_sec = ink_hrtime_to_sec(Thread::get_hrtime_updated());
+
   InactivityCop *inactivityCop = new InactivityCop(get_NetHandler(thread)->mutex);
   int cop_freq                 = 1;
 
@@ -478,10 +503,12 @@ NetHandler::waitForActivity(ink_hrtime timeout)
     epd = (EventIO *)get_ev_data(pd, x);
     if (epd->type == EVENTIO_READWRITE_VC) {
       vc = epd->data.vc;
-      // Remove triggered NetVC from cop_list because it won't be timeout before next InactivityCop runs.
-      if (cop_list.in(vc)) {
-        cop_list.remove(vc);
+#if TS_HAS_ZEROCOPY
+      // Zero copy completions are queued on the socket error queue.
+      if ((get_ev_events(pd, x) & EVENTIO_ERROR) && !vc->zerocopy_pending.empty()) {
+        zerocopy_reap(vc->con.fd, vc->zerocopy_pending, this->thread);
       }
+#endif
       if (get_ev_events(pd, x) & (EVENTIO_READ | EVENTIO_ERROR)) {
         vc->read.triggered = 1;
         if (!read_ready_list.in(vc)) {
@@ -522,9 +549,50 @@ NetHandler::waitForActivity(ink_hrtime timeout)
 
   process_ready_list();
 
+  if (!zerocopy_linger_list.empty()) {
+    reap_zerocopy_linger();
+  }
+
   return EVENT_CONT;
 }
 
+void
+NetHandler::linger_zerocopy(int fd, Queue<ZeroCopySend> &pending)
+{
+  ZeroCopyLinger *zl = new ZeroCopyLinger;
+
+  // Nothing more will be read or written, let the peer see the close now.
+  shutdown(fd, SHUT_RDWR);
+
+  zl->fd        = fd;
+  zl->expire_at = Thread::get_hrtime() + ZEROCOPY_LINGER_TIMEOUT;
+  zl->pending   = pending;
+  pending.clear();
+  zerocopy_linger_list.enqueue(zl);
+}
+
+void
+NetHandler::reap_zerocopy_linger()
+{
+  ink_hrtime now = Thread::get_hrtime();
+  ZeroCopyLinger *next;
+
+  for (ZeroCopyLinger *zl = zerocopy_linger_list.head; zl; zl = next) {
+    next = zl->link.next;
+#if TS_HAS_ZEROCOPY
+    zerocopy_reap(zl->fd, zl->pending, this->thread);
+#endif
+    if (zl->pending.empty() || zl->expire_at < now) {
+      zerocopy_linger_list.remove(zl);
+#if TS_HAS_ZEROCOPY
+      zerocopy_release(zl->pending);
+#endif
+      socketManager.close(zl->fd);
+      delete zl;
+    }
+  }
+}
+
 void
 NetHandler::signalActivity()
 {
@@ -714,6 +782,7 @@ NetHandler::add_to_active_queue(UnixNetVConnection *vc)
     ++active_queue_size;
   }
   active_queue.enqueue(vc);
+  update_cop_deadline(vc);
 
   return true;
 }
@@ -77,7 +77,12 @@ net_accept(NetAccept *na, void *ep, bool blockable)
     }
     NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
 
+    if (!na->admit_client(con)) {
+      continue;
+    }
+
     vc = static_cast<UnixNetVConnection *>(na->getNetProcessor()->allocate_vc(e->ethread));
+    na->charge_client(vc, con);
     if (!vc) {
       goto Ldone; // note: @a con will clean up the socket when it goes out of scope.
     }
@@ -275,8 +280,13 @@ NetAccept::do_blocking_accept(EThread *t)
       return 0;
     }
 
+    if (!admit_client(con)) {
+      continue;
+    }
+
     // Use 'nullptr' to Bypass thread allocator
     vc = (UnixNetVConnection *)this->getNetProcessor()->allocate_vc(nullptr);
+    charge_client(vc, con);
     if (unlikely(!vc || shutdown_event_system == true)) {
       return -1;
     }
@@ -431,7 +441,12 @@ NetAccept::acceptFastEvent(int event, void *ep)
       goto Lerror;
     }
 
+    if (!admit_client(con)) {
+      continue;
+    }
+
     vc = (UnixNetVConnection *)this->getNetProcessor()->allocate_vc(e->ethread);
+    charge_client(vc, con);
     if (!vc) {
       goto Ldone;
     }
@@ -490,6 +505,34 @@ NetAccept::acceptLoopEvent(int event, Event *e)
   return EVENT_DONE;
 }
 
+bool
+NetAccept::admit_client(Connection &con)
+{
+  if (client_limiter && !client_limiter->admit(&con.addr.sa, Thread::get_hrtime_updated())) {
+    if (is_debug_tag_set("net_accept")) {
+      ip_port_text_buffer ipb;
+      Debug("net_accept", "client %s is over its connection limits, closing", ats_ip_nptop(&con.addr, ipb, sizeof(ipb)));
+    }
+    NET_SUM_GLOBAL_DYN_STAT(net_client_connections_throttled_stat, 1);
+    con.close();
+    return false;
+  }
+  return true;
+}
+
+void
+NetAccept::charge_client(UnixNetVConnection *vc, Connection &con)
+{
+  if (!client_limiter || !client_limiter->max_connections) {
+    return;
+  }
+  if (vc) {
+    vc->client_limiter = client_limiter;
+  } else {
+    client_limiter->release(&con.addr.sa);
+  }
+}
+
 //
 // Accept Event handler
 //
@@ -38,20 +38,23 @@ NetProcessor::AcceptOptions::reset()
 {
   local_port = 0;
   local_ip.invalidate();
-  accept_threads        = -1;
-  ip_family             = AF_INET;
-  etype                 = ET_NET;
-  f_callback_on_open    = false;
-  localhost_only        = false;
-  frequent_accept       = true;
-  backdoor              = false;
-  recv_bufsize          = 0;
-  send_bufsize          = 0;
-  sockopt_flags         = 0;
-  packet_mark           = 0;
-  packet_tos            = 0;
-  tfo_queue_length      = 0;
-  f_inbound_transparent = false;
+  accept_threads          = -1;
+  ip_family               = AF_INET;
+  etype                   = ET_NET;
+  f_callback_on_open      = false;
+  localhost_only          = false;
+  frequent_accept         = true;
+  backdoor                = false;
+  recv_bufsize            = 0;
+  send_bufsize            = 0;
+  sockopt_flags           = 0;
+  packet_mark             = 0;
+  packet_tos              = 0;
+  tfo_queue_length        = 0;
+  client_max_connections  = 0;
+  client_connection_rate  = 0;
+  client_connection_burst = 0;
+  f_inbound_transparent   = false;
   return *this;
 }
 
@@ -118,6 +121,13 @@ UnixNetProcessor::accept_internal(Continuation *cont, int fd, AcceptOptions cons
 
   na->accept_fn = net_accept; // All callers used this.
   na->server.fd = fd;
+
+  if (opt.client_max_connections > 0 || opt.client_connection_rate > 0) {
+    na->client_limiter =
+      make_ptr(new NetClientLimiter(opt.client_max_connections, opt.client_connection_rate, opt.client_connection_burst));
+    Debug("iocore_net_accept", "limiting clients on port %d to %d connections, %d per second", opt.local_port,
+          opt.client_max_connections, opt.client_connection_rate);
+  }
   ats_ip_copy(&na->server.accept_addr, &accept_ip);
 
   if (opt.f_inbound_transparent) {
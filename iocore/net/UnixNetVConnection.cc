@@ -27,12 +27,16 @@
 #include "Log.h"
 
 #include <termios.h>
+#if TS_HAS_ZEROCOPY
+#include <linux/errqueue.h>
+#endif
 
 #define STATE_VIO_OFFSET ((uintptr_t) & ((NetState *)0)->vio)
 #define STATE_FROM_VIO(_x) ((NetState *)(((char *)(_x)) - STATE_VIO_OFFSET))
 
 // Global
 ClassAllocator<UnixNetVConnection> netVCAllocator("netVCAllocator");
+ClassAllocator<ZeroCopySend> zeroCopySendAllocator("zeroCopySendAllocator");
 
 //
 // Reschedule a UnixNetVConnection by moving it
@@ -67,6 +71,9 @@ net_activity(UnixNetVConnection *vc, EThread *thread)
   (void)thread;
   if (vc->inactivity_timeout_in) {
     vc->next_inactivity_timeout_at = Thread::get_hrtime() + vc->inactivity_timeout_in;
+    if (vc->nh) {
+      vc->nh->update_cop_deadline(vc);
+    }
   } else {
     vc->next_inactivity_timeout_at = 0;
   }
@@ -216,6 +223,16 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     return;
   }
   int64_t toread = buf.writer()->write_avail();
+
+  // Splice only once everything read into the buffer has been consumed, so
+  // the bytes reach the other side in order.
+  NetSplicePipe *pipe = vc->splice_in.get();
+  if (pipe && buf.writer()->max_read_avail() == 0) {
+    toread = pipe->size - pipe->occupied;
+  } else {
+    pipe = nullptr;
+  }
+
   if (toread > ntodo) {
     toread = ntodo;
   }
@@ -224,7 +241,17 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   int64_t rattempted = 0, total_read = 0;
   unsigned niov = 0;
   IOVec tiovec[NET_MAX_IOV];
-  if (toread) {
+  if (toread && pipe) {
+    r = pipe->fill(vc->con.fd, toread);
+    NET_INCREMENT_DYN_STAT(net_calls_to_read_stat);
+
+    if (r == -EAGAIN && pipe->occupied > 0) {
+      // The pipe can run out of slots before it is out of bytes, wait for
+      // the writer to drain it rather than for the socket to signal again.
+      read_disable(nh, vc);
+      return;
+    }
+  } else if (toread) {
     IOBufferBlock *b = buf.writer()->first_write_block();
     do {
       niov       = 0;
@@ -282,6 +309,9 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
         r = total_read - rattempted + r;
       }
     }
+  }
+
+  if (toread) {
     // check for errors
     if (r <= 0) {
       if (r == -EAGAIN || r == -ENOTCONN) {
@@ -304,7 +334,9 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     NET_SUM_DYN_STAT(net_read_bytes_stat, r);
 
     // Add data to buffer and signal continuation.
-    buf.writer()->fill(r);
+    if (!pipe) {
+      buf.writer()->fill(r);
+    }
 #ifdef DEBUG
     if (buf.writer()->write_avail() <= 0)
       Debug("iocore_net", "read_from_net, read buffer full");
@@ -336,7 +368,7 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     }
   }
   // If here are is no more room, or nothing to do, disable the connection
-  if (s->vio.ntodo() <= 0 || !s->enabled || !buf.writer()->write_avail()) {
+  if (s->vio.ntodo() <= 0 || !s->enabled || !buf.writer()->write_avail() || (pipe && pipe->occupied >= pipe->size)) {
     read_disable(nh, vc);
     return;
   }
@@ -423,7 +455,7 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   ink_assert(buf.writer());
 
   // Calculate the amount to write.
-  int64_t towrite = buf.reader()->read_avail();
+  int64_t towrite = vc->write_avail_in(buf);
   if (towrite > ntodo) {
     towrite = ntodo;
   }
@@ -445,7 +477,7 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     signalled = 1;
 
     // Recalculate amount to write
-    towrite = buf.reader()->read_avail();
+    towrite = vc->write_avail_in(buf);
     if (towrite > ntodo) {
       towrite = ntodo;
     }
@@ -533,7 +565,7 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
       read_reschedule(nh, vc);
     }
 
-    if (!(buf.reader()->is_read_avail_more_than(0))) {
+    if (vc->write_avail_in(buf) <= 0) {
       write_disable(nh, vc);
       return;
     }
@@ -598,6 +630,7 @@ UnixNetVConnection::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
   read.vio.nbytes    = nbytes;
   read.vio.ndone     = 0;
   read.vio.vc_server = (VConnection *)this;
+  splice_in          = nullptr;
   if (buf) {
     read.vio.buffer.writer_for(buf);
     if (!read.enabled) {
@@ -623,6 +656,8 @@ UnixNetVConnection::do_io_write(Continuation *c, int64_t nbytes, IOBufferReader
   write.vio.nbytes    = nbytes;
   write.vio.ndone     = 0;
   write.vio.vc_server = (VConnection *)this;
+  ink_assert(!splice_out || splice_out->occupied == 0);
+  splice_out = nullptr;
   if (reader) {
     ink_assert(!owner);
     write.vio.buffer.reader_for(reader);
@@ -671,6 +706,8 @@ UnixNetVConnection::do_io_close(int alerrno /* = -1 */)
     } else {
       free(t);
     }
+  } else {
+    nh->update_cop_deadline(this);
   }
 }
 
@@ -880,6 +917,8 @@ UnixNetVConnection::UnixNetVConnection()
     active_timeout_in(0),
     next_inactivity_timeout_at(0),
     next_activity_timeout_at(0),
+    cop_filed_at(0),
+    in_cop_resched_list(0),
     nh(nullptr),
     id(0),
     flags(0),
@@ -890,7 +929,9 @@ UnixNetVConnection::UnixNetVConnection()
     accept_object(nullptr),
     origin_trace(false),
     origin_trace_addr(nullptr),
-    origin_trace_port(0)
+    origin_trace_port(0),
+    zerocopy_seq(0),
+    zerocopy_enabled(false)
 {
   SET_HANDLER((NetVConnHandler)&UnixNetVConnection::startEvent);
 }
@@ -905,6 +946,9 @@ UnixNetVConnection::set_enabled(VIO *vio)
   STATE_FROM_VIO(vio)->enabled = 1;
   if (!next_inactivity_timeout_at && inactivity_timeout_in) {
     next_inactivity_timeout_at = Thread::get_hrtime() + inactivity_timeout_in;
+    if (nh) {
+      nh->update_cop_deadline(this);
+    }
   }
 }
 
@@ -921,8 +965,22 @@ UnixNetVConnection::net_read_io(NetHandler *nh, EThread *lthread)
 int64_t
 UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs)
 {
-  int64_t r                  = 0;
-  int64_t try_to_write       = 0;
+  int64_t r            = 0;
+  int64_t try_to_write = 0;
+
+  if (splice_out && splice_out->occupied > 0 && !buf.reader()->is_read_avail_more_than(0)) {
+    ProxyMutex *mutex = thread->mutex.get();
+
+    r = splice_out->drain(con.fd, towrite);
+    if (r > 0) {
+      total_written += r;
+      NET_SUM_DYN_STAT(net_spliced_bytes_stat, r);
+    }
+    NET_INCREMENT_DYN_STAT(net_calls_to_write_stat);
+    needs |= EVENTIO_WRITE;
+    return r;
+  }
+
   IOBufferReader *tmp_reader = buf.reader()->clone();
 
   do {
@@ -986,7 +1044,27 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
       }
 
     } else {
+#if TS_HAS_ZEROCOPY
+      if (zerocopy_enabled && net_zerocopy_min_write > 0 && try_to_write >= net_zerocopy_min_write) {
+        struct msghdr msg;
+
+        ink_zero(msg);
+        msg.msg_iov    = &tiovec[0];
+        msg.msg_iovlen = niov;
+
+        r = socketManager.sendmsg(con.fd, &msg, MSG_ZEROCOPY);
+        if (r > 0) {
+          zerocopy_pin(buf.reader(), r);
+        } else if (r == -ENOBUFS) {
+          // Out of socket option memory to pin the pages, copy this write instead.
+          r = socketManager.writev(con.fd, &tiovec[0], niov);
+        }
+      } else {
+        r = socketManager.writev(con.fd, &tiovec[0], niov);
+      }
+#else
       r = socketManager.writev(con.fd, &tiovec[0], niov);
+#endif
     }
 
     if (origin_trace) {
@@ -1021,6 +1099,167 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
   return r;
 }
 
+#if TS_HAS_ZEROCOPY
+// Hold the first @a len bytes of @a reader until the kernel completes the
+// zero copy send that was just issued for them.
+void
+UnixNetVConnection::zerocopy_pin(IOBufferReader *reader, int64_t len)
+{
+  ProxyMutex *mutex = thread->mutex.get();
+  ZeroCopySend *zc  = zeroCopySendAllocator.alloc();
+
+  zc->seq    = zerocopy_seq++;
+  zc->done   = false;
+  zc->blocks = iobufferblock_clone(reader->block.get(), reader->start_offset, len);
+  zerocopy_pending.enqueue(zc);
+
+  NET_INCREMENT_DYN_STAT(net_zerocopy_writes_stat);
+  NET_SUM_DYN_STAT(net_zerocopy_bytes_stat, len);
+}
+
+void
+zerocopy_reap(int fd, Queue<ZeroCopySend> &pending, EThread *thread)
+{
+  ProxyMutex *mutex = thread->mutex.get();
+
+  while (!pending.empty()) {
+    char control[128];
+    struct msghdr msg;
+
+    ink_zero(msg);
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      // EAGAIN, nothing more has completed.
+      break;
+    }
+
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+      if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+            (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) {
+        continue;
+      }
+
+      struct sock_extended_err *serr = reinterpret_cast<struct sock_extended_err *>(CMSG_DATA(cm));
+      if (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr->ee_errno != 0) {
+        continue;
+      }
+      if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+        NET_INCREMENT_DYN_STAT(net_zerocopy_copied_stat);
+      }
+
+      // The notification covers the sends numbered [ee_info, ee_data].
+      uint32_t lo = serr->ee_info;
+      uint32_t hi = serr->ee_data;
+      for (ZeroCopySend *zc = pending.head; zc; zc = zc->link.next) {
+        if (zc->seq - lo <= hi - lo) {
+          zc->done = true;
+        }
+      }
+    }
+
+    // Ranges normally complete in order, but only release a prefix in case they do not.
+    while (pending.head && pending.head->done) {
+      ZeroCopySend *zc = pending.dequeue();
+      zc->blocks       = nullptr;
+      zeroCopySendAllocator.free(zc);
+    }
+  }
+}
+
+void
+zerocopy_release(Queue<ZeroCopySend> &pending)
+{
+  while (ZeroCopySend *zc = pending.dequeue()) {
+    zc->blocks = nullptr;
+    zeroCopySendAllocator.free(zc);
+  }
+}
+#endif
+
+bool
+UnixNetVConnection::splice_to(NetVConnection *dst)
+{
+#if HAVE_SPLICE
+  UnixNetVConnection *dst_vc = dynamic_cast<UnixNetVConnection *>(dst);
+
+  // The pipe is shared without locking, so both ends must be plain sockets on this thread.
+  if (dst_vc == nullptr || dynamic_cast<SSLNetVConnection *>(dst_vc) || dst_vc->thread != thread || origin_trace ||
+      dst_vc->origin_trace) {
+    return false;
+  }
+
+  Ptr<NetSplicePipe> pipe = make_ptr(new NetSplicePipe);
+  if (!pipe->open()) {
+    Debug("iocore_net", "splice_to: unable to create pipe: %s", strerror(errno));
+    return false;
+  }
+
+  splice_in          = pipe;
+  dst_vc->splice_out = pipe;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool
+NetSplicePipe::open()
+{
+#if HAVE_SPLICE
+  if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+    return false;
+  }
+#ifdef F_GETPIPE_SZ
+  size = fcntl(fds[1], F_GETPIPE_SZ);
+#endif
+  if (size <= 0) {
+    size = 16 * ats_pagesize(); // Linux default
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+int64_t
+NetSplicePipe::fill(int fd, int64_t len)
+{
+#if HAVE_SPLICE
+  int64_t r = socketManager.splice(fd, fds[1], len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (r > 0) {
+    occupied += r;
+  }
+  return r;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+int64_t
+NetSplicePipe::drain(int fd, int64_t len)
+{
+#if HAVE_SPLICE
+  int64_t r = socketManager.splice(fds[0], fd, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (r > 0) {
+    occupied -= r;
+  }
+  return r;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+NetSplicePipe::~NetSplicePipe()
+{
+  for (int fd : fds) {
+    if (fd != NO_FD) {
+      socketManager.close(fd);
+    }
+  }
+}
+
 void
 UnixNetVConnection::readDisable(NetHandler *nh)
 {
@@ -1325,6 +1564,11 @@ fail:
 void
 UnixNetVConnection::clear()
 {
+  if (client_limiter) {
+    client_limiter->release(&con.addr.sa);
+    client_limiter = nullptr;
+  }
+
   // clear timeout variables
   next_inactivity_timeout_at = 0;
   next_activity_timeout_at   = 0;
@@ -1352,6 +1596,13 @@ UnixNetVConnection::clear()
   options.reset();
   closed        = 0;
   netvc_context = NET_VCONNECTION_UNSET;
+#if TS_HAS_ZEROCOPY
+  ink_assert(zerocopy_pending.empty());
+#endif
+  zerocopy_seq     = 0;
+  zerocopy_enabled = false;
+  splice_in        = nullptr;
+  splice_out       = nullptr;
   ink_assert(!read.ready_link.prev && !read.ready_link.next);
   ink_assert(!read.enable_link.next);
   ink_assert(!write.ready_link.prev && !write.ready_link.next);
@@ -1370,6 +1621,18 @@ UnixNetVConnection::free(EThread *t)
   if (con.fd != NO_FD) {
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, -1);
   }
+#if TS_HAS_ZEROCOPY
+  if (!zerocopy_pending.empty() && con.fd != NO_FD) {
+    zerocopy_reap(con.fd, zerocopy_pending, t);
+    if (!zerocopy_pending.empty()) {
+      // The kernel may still send from the pinned buffers, keep the socket
+      // open until it is done with them.
+      get_NetHandler(t)->linger_zerocopy(con.fd, zerocopy_pending);
+      con.fd = NO_FD;
+    }
+  }
+  zerocopy_release(zerocopy_pending);
+#endif
   con.close();
 
   clear();
@@ -1388,6 +1651,13 @@ void
 UnixNetVConnection::apply_options()
 {
   con.apply_options(options);
+
+#if TS_HAS_ZEROCOPY
+  if ((options.sockopt_flags & NetVCOptions::SOCK_OPT_ZERO_COPY) && !zerocopy_enabled && con.fd != NO_FD) {
+    zerocopy_enabled = safe_setsockopt(con.fd, SOL_SOCKET, SO_ZEROCOPY, SOCKOPT_ON, sizeof(int)) == 0;
+    Debug("socket", "::apply_options: setsockopt() SO_ZEROCOPY on socket %s", zerocopy_enabled ? "succeeded" : "failed");
+  }
+#endif
 }
 
 TS_INLINE void
@@ -1400,6 +1670,20 @@ UnixNetVConnection::set_inactivity_timeout(ink_hrtime timeout_in)
   }
   inactivity_timeout_in      = timeout_in;
   next_inactivity_timeout_at = Thread::get_hrtime() + inactivity_timeout_in;
+  if (nh) {
+    nh->update_cop_deadline(this);
+  }
+}
+
+TS_INLINE void
+UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
+{
+  Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
+  active_timeout_in        = timeout_in;
+  next_activity_timeout_at = Thread::get_hrtime() + timeout_in;
+  if (nh) {
+    nh->update_cop_deadline(this);
+  }
 }
 
 /*
@@ -1472,6 +1756,14 @@ UnixNetVConnection::migrateToCurrentThread(Continuation *cont, EThread *t)
     }
     ink_assert(this->con.fd == NO_FD);
 
+    // The socket moved, so do the zero copy sends still in flight on it.
+    ret_vc->zerocopy_pending = this->zerocopy_pending;
+    ret_vc->zerocopy_seq     = this->zerocopy_seq;
+    ret_vc->zerocopy_enabled = this->zerocopy_enabled;
+    this->zerocopy_pending.clear();
+    ret_vc->client_limiter = this->client_limiter;
+    this->client_limiter   = nullptr;
+
     // Do_io_close will signal the VC to be freed on the original thread
     // Since we moved the con context, the fd will not be closed
     // Go ahead and remove the fd from the original thread's epoll structure, so it is not
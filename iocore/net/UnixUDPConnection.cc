@@ -147,8 +147,6 @@ UDPConnection::Release()
 {
   UnixUDPConnection *p = (UnixUDPConnection *)this;
 
-  p->ep.stop();
-
   if (ink_atomic_increment(&p->refcount, -1) == 1) {
     ink_assert(p->callback_link.next == nullptr);
     ink_assert(p->callback_link.prev == nullptr);
@@ -156,6 +154,9 @@ UDPConnection::Release()
     ink_assert(p->polling_link.prev == nullptr);
     ink_assert(p->newconn_alink.next == nullptr);
 
+    // Only stop polling once the last reference is gone, otherwise the
+    // socket is dropped from epoll after the first read callback.
+    p->ep.stop();
     delete this;
   }
 }
@@ -102,6 +102,56 @@ UDPNetProcessorInternal::start(int n_upd_threads, size_t stacksize)
   return 0;
 }
 
+#if HAVE_RECVMMSG
+// Cleared if the kernel turns out not to implement recvmmsg().
+static bool udp_recvmmsg_supported = true;
+
+// Drain the socket UDP_READ_BATCH_SIZE datagrams per system call. Returns the
+// number of packets queued, or -1 if recvmmsg() is not available.
+static int
+udp_read_from_net_batch(UDPNetHandler *nh, UnixUDPConnection *uc)
+{
+  struct mmsghdr msgs[UDP_READ_BATCH_SIZE];
+  struct iovec iov[UDP_READ_BATCH_SIZE];
+  sockaddr_in6 fromaddr[UDP_READ_BATCH_SIZE];
+  int r;
+  int iters = 0;
+
+  if (nh->read_buffer == nullptr) {
+    nh->read_buffer = static_cast<char *>(ats_malloc(UDP_READ_BATCH_SIZE * UDP_READ_BUFFER_SIZE));
+  }
+
+  do {
+    for (int i = 0; i < UDP_READ_BATCH_SIZE; ++i) {
+      iov[i].iov_base = nh->read_buffer + i * UDP_READ_BUFFER_SIZE;
+      iov[i].iov_len  = UDP_READ_BUFFER_SIZE;
+      memset(&msgs[i], 0, sizeof(msgs[i]));
+      msgs[i].msg_hdr.msg_name    = &fromaddr[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(fromaddr[i]);
+      msgs[i].msg_hdr.msg_iov     = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen  = 1;
+    }
+    r = socketManager.recvmmsg(uc->getFd(), msgs, UDP_READ_BATCH_SIZE, 0);
+    if (r == -ENOSYS) {
+      udp_recvmmsg_supported = false;
+      return -1;
+    }
+    if (r <= 0) {
+      break;
+    }
+    for (int i = 0; i < r; ++i) {
+      UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr[i]), static_cast<char *>(iov[i].iov_base), msgs[i].msg_len);
+      p->setConnection(uc);
+      ink_atomiclist_push(&uc->inQueue, p);
+    }
+    iters += r;
+    // A short batch means the socket receive queue has been drained.
+  } while (r == UDP_READ_BATCH_SIZE);
+
+  return iters;
+}
+#endif
+
 void
 UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc)
 {
@@ -110,27 +160,35 @@ UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc
   // receive packet and queue onto UDPConnection.
   // don't call back connection at this time.
   int r;
-  int iters = 0;
-  do {
-    sockaddr_in6 fromaddr;
-    socklen_t fromlen = sizeof(fromaddr);
-    // XXX: want to be 0 copy.
-    // XXX: really should read into next contiguous region of an IOBufferData
-    // which gets referenced by IOBufferBlock.
-    char buf[65536];
-    int buflen = sizeof(buf);
-    r          = socketManager.recvfrom(uc->getFd(), buf, buflen, 0, (struct sockaddr *)&fromaddr, &fromlen);
-    if (r <= 0) {
-      // error
-      break;
-    }
-    // create packet
-    UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr), buf, r);
-    p->setConnection(uc);
-    // queue onto the UDPConnection
-    ink_atomiclist_push(&uc->inQueue, p);
-    iters++;
-  } while (r > 0);
+  int iters = -1;
+#if HAVE_RECVMMSG
+  if (udp_recvmmsg_supported) {
+    iters = udp_read_from_net_batch(nh, uc);
+  }
+#endif
+  if (iters < 0) {
+    iters = 0;
+    do {
+      sockaddr_in6 fromaddr;
+      socklen_t fromlen = sizeof(fromaddr);
+      // XXX: want to be 0 copy.
+      // XXX: really should read into next contiguous region of an IOBufferData
+      // which gets referenced by IOBufferBlock.
+      char buf[65536];
+      int buflen = sizeof(buf);
+      r          = socketManager.recvfrom(uc->getFd(), buf, buflen, 0, (struct sockaddr *)&fromaddr, &fromlen);
+      if (r <= 0) {
+        // error
+        break;
+      }
+      // create packet
+      UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr), buf, r);
+      p->setConnection(uc);
+      // queue onto the UDPConnection
+      ink_atomiclist_push(&uc->inQueue, p);
+      iters++;
+    } while (r > 0);
+  }
   if (iters >= 1) {
     Debug("udp-read", "read %d at a time", iters);
   }
@@ -709,6 +767,8 @@ UDPQueue::SendPackets()
   int32_t bytesThisSlot = INT_MAX, bytesUsed = 0;
   int32_t bytesThisPipe, sentOne;
   int64_t pktLen;
+  UDPPacketInternal *batch[UDP_SEND_BATCH_SIZE];
+  int nbatch = 0;
 
   bytesThisSlot = INT_MAX;
 
@@ -720,25 +780,30 @@ sendPackets:
     p      = pipeInfo.getFirstPacket();
     pktLen = p->getPktLength();
 
-    if (p->conn->shouldDestroy()) {
-      goto next_pkt;
-    }
-    if (p->conn->GetSendGenerationNumber() != p->reqGenerationNum) {
-      goto next_pkt;
+    if (p->conn->shouldDestroy() || p->conn->GetSendGenerationNumber() != p->reqGenerationNum) {
+      p->free();
+    } else {
+      // Packets are batched per connection so that each batch is a single sendmmsg() call.
+      if (nbatch == UDP_SEND_BATCH_SIZE || (nbatch > 0 && batch[0]->conn != p->conn)) {
+        SendMultipleUDPPackets(batch, nbatch);
+        nbatch = 0;
+      }
+      batch[nbatch++] = p;
+      bytesUsed += pktLen;
+      bytesThisPipe -= pktLen;
     }
-
-    SendUDPPacket(p, pktLen);
-    bytesUsed += pktLen;
-    bytesThisPipe -= pktLen;
-  next_pkt:
     sentOne = true;
-    p->free();
 
     if (bytesThisPipe < 0) {
       break;
     }
   }
 
+  if (nbatch > 0) {
+    SendMultipleUDPPackets(batch, nbatch);
+    nbatch = 0;
+  }
+
   bytesThisSlot -= bytesUsed;
 
   if ((bytesThisSlot > 0) && sentOne) {
@@ -804,6 +869,97 @@ UDPQueue::SendUDPPacket(UDPPacketInternal *p, int32_t /* pktLen ATS_UNUSED */)
   }
 }
 
+#if HAVE_SENDMMSG
+// Push out a set of prepared messages on fd, retrying on EAGAIN the same way
+// SendUDPPacket() does.
+static void
+udp_send_mmsg(int fd, struct mmsghdr *msgs, int nmsgs)
+{
+  int sent  = 0;
+  int count = 0;
+  int res;
+
+  while (sent < nmsgs) {
+    res = socketManager.sendmmsg(fd, msgs + sent, nmsgs - sent, 0);
+    if (res > 0) {
+      sent += res;
+      count = 0;
+    } else if (res == -EAGAIN) {
+      // stupid Linux problem: sendmmsg can return EAGAIN
+      ++count;
+      if ((g_udp_numSendRetries > 0) && (count >= g_udp_numSendRetries)) {
+        // tried too many times; give up on the rest of the batch
+        Debug("udpnet", "Send failed: too many retries");
+        break;
+      }
+    } else {
+      // The first remaining message failed, skip it and carry on with the rest.
+      Debug("udpnet", "Send failed: %s", strerror(-res));
+      ++sent;
+    }
+  }
+}
+#endif
+
+// Send and free a batch of packets that all belong to the same connection.
+void
+UDPQueue::SendMultipleUDPPackets(UDPPacketInternal **p, int n)
+{
+#if HAVE_SENDMMSG
+  struct mmsghdr msgs[UDP_SEND_BATCH_SIZE];
+  struct iovec iov[UDP_SEND_BATCH_SIZE * UDP_SEND_MAX_IOV];
+  int fd    = p[0]->conn->getFd();
+  int nmsgs = 0;
+  int iovs  = 0;
+
+  ink_assert(n <= UDP_SEND_BATCH_SIZE);
+
+  for (int i = 0; i < n; ++i) {
+    struct msghdr *msg = &msgs[nmsgs].msg_hdr;
+    int iov_len        = 0;
+    IOBufferBlock *b;
+
+    ink_assert(p[i]->conn == p[0]->conn);
+
+    for (b = p[i]->chain.get(); b != nullptr && iov_len < UDP_SEND_MAX_IOV; b = b->next.get()) {
+      iov[iovs + iov_len].iov_base = (caddr_t)b->start();
+      iov[iovs + iov_len].iov_len  = b->size();
+      iov_len++;
+    }
+    if (b != nullptr) {
+      // Too fragmented for the batch iovec; flush what we have so far to keep
+      // packet order and send this one with sendmsg().
+      udp_send_mmsg(fd, msgs, nmsgs);
+      nmsgs = 0;
+      iovs  = 0;
+      SendUDPPacket(p[i], 0);
+      continue;
+    }
+
+    p[i]->conn->lastSentPktStartTime = p[i]->delivery_time;
+    Debug("udp-send", "Sending %p", p[i]);
+
+    memset(msg, 0, sizeof(*msg));
+    msg->msg_name    = (caddr_t)&p[i]->to.sa;
+    msg->msg_namelen = ats_ip_size(&p[i]->to.sa);
+    msg->msg_iov     = &iov[iovs];
+    msg->msg_iovlen  = iov_len;
+    iovs += iov_len;
+    nmsgs++;
+  }
+
+  udp_send_mmsg(fd, msgs, nmsgs);
+#else
+  for (int i = 0; i < n; ++i) {
+    SendUDPPacket(p[i], 0);
+  }
+#endif
+
+  for (int i = 0; i < n; ++i) {
+    p[i]->free();
+  }
+}
+
 void
 UDPQueue::send(UDPPacket *p)
 {
@@ -833,6 +989,20 @@ UDPNetHandler::startNetEvent(int event, Event *e)
   return EVENT_CONT;
 }
 
+// Drop the reference the net handler holds on a destroyed connection. Polling
+// stops at the same time, so neither the poll loop nor the sweep can drop it twice.
+static void
+release_destroyed_connection(UDPNetHandler *nh, UnixUDPConnection *uc)
+{
+  if (nh->udp_polling.in(uc)) {
+    nh->udp_polling.remove(uc);
+  }
+  if (uc->ep.event_loop) {
+    uc->ep.stop();
+    uc->Release();
+  }
+}
+
 int
 UDPNetHandler::mainNetEvent(int event, Event *e)
 {
@@ -858,8 +1028,7 @@ UDPNetHandler::mainNetEvent(int event, Event *e)
       ink_assert(uc && uc->mutex && uc->continuation);
       ink_assert(uc->refcount >= 1);
       if (uc->shouldDestroy()) {
-        // udp_polling->remove(uc,uc->polling_link);
-        uc->Release();
+        release_destroyed_connection(this, uc);
       } else {
         udpNetInternal.udp_read_from_net(this, uc);
         nread++;
@@ -875,9 +1044,7 @@ UDPNetHandler::mainNetEvent(int event, Event *e)
       ink_assert(uc->refcount >= 1);
       next = uc->polling_link.next;
       if (uc->shouldDestroy()) {
-        // changed by YTS Team, yamsat
-        // udp_polling->remove(uc,uc->polling_link);
-        uc->Release();
+        release_destroyed_connection(this, uc);
       }
     }
     nextCheck = Thread::get_hrtime_updated() + HRTIME_MSECONDS(1000);
@@ -40,6 +40,10 @@ static const char payload[] = "hello";
 in_port_t port              = 0;
 int pfd[2]; // Pipe used to signal client with transient port.
 
+// Loopback throughput run: BURST_ROUNDS rounds of BURST_SIZE datagrams in flight.
+static const int BURST_SIZE   = 64;
+static const int BURST_ROUNDS = 16;
+
 /*This implements a standard Unix echo server: just send every udp packet you
   get back to where it came from*/
 
@@ -186,6 +190,59 @@ udp_client(char *buf)
   close(sock);
 }
 
+// Echo BURST_SIZE datagrams at a time so the server sees batches to read and
+// send, and report the round trip rate. Returns the number of datagrams echoed.
+int
+udp_client_burst()
+{
+  char pkt[512];
+  char buf[sizeof(pkt)];
+  int received = 0;
+  int sock     = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0) {
+    std::cout << "Couldn't create socket" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  struct timeval tv;
+  tv.tv_sec  = 5;
+  tv.tv_usec = 0;
+
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char *)&tv, sizeof(tv));
+  int bufsize = 1024000;
+  setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char *)&bufsize, sizeof(bufsize));
+
+  sockaddr_in addr;
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = htons(port);
+
+  memset(pkt, 'x', sizeof(pkt));
+  ink_hrtime start = ink_get_hrtime_internal();
+  for (int round = 0; round < BURST_ROUNDS; ++round) {
+    for (int i = 0; i < BURST_SIZE; ++i) {
+      if (sendto(sock, pkt, sizeof(pkt), 0, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        std::cout << "Couldn't send udp packet" << std::endl;
+        close(sock);
+        std::exit(EXIT_FAILURE);
+      }
+    }
+    for (int i = 0; i < BURST_SIZE; ++i) {
+      if (recv(sock, buf, sizeof(buf), 0) != sizeof(pkt)) {
+        break;
+      }
+      ++received;
+    }
+  }
+  ink_hrtime elapsed = ink_get_hrtime_internal() - start;
+
+  std::cout << "UDP echo burst: " << received << " packets in " << ink_hrtime_to_msec(elapsed) << " ms ("
+            << (elapsed ? static_cast<int64_t>(received * HRTIME_SECOND / elapsed) : 0) << " packets/sec)" << std::endl;
+
+  close(sock);
+  return received;
+}
+
 REGRESSION_TEST(UDPNet_echo)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
 {
   TestBox box(t, pstatus);
@@ -212,6 +269,7 @@ REGRESSION_TEST(UDPNet_echo)(RegressionTest *t, int /* atype ATS_UNUSED */, int
       std::exit(EXIT_FAILURE);
     }
     udp_client(buf);
+    int echoed = udp_client_burst();
 
     kill(pid, SIGTERM);
     int status;
@@ -219,6 +277,7 @@ REGRESSION_TEST(UDPNet_echo)(RegressionTest *t, int /* atype ATS_UNUSED */, int
 
     if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
       box.check(strncmp(buf, payload, sizeof(payload)) == 0, "echo doesn't match");
+      box.check(echoed == BURST_SIZE * BURST_ROUNDS, "burst echoed %d of %d packets", echoed, BURST_SIZE * BURST_ROUNDS);
     } else {
       std::cout << "UDP Echo Server exit failure" << std::endl;
       std::exit(EXIT_FAILURE);
@@ -258,6 +258,10 @@ public:
   static HostResPreferenceOrder const DEFAULT_HOST_RES_PREFERENCE;
   /// Enabled session transports for this port.
   SessionProtocolSet m_session_protocol_preference;
+  /// Maximum open connections per client address, -1 to use the global setting.
+  int m_client_max_connections;
+  /// Maximum new connections per second per client address, -1 to use the global setting.
+  int m_client_connection_rate;
 
   /// Default constructor.
   HttpProxyPort();
@@ -394,6 +398,8 @@ public:
   static const char *const OPT_COMPRESSED;              ///< Compressed.
   static const char *const OPT_HOST_RES_PREFIX;         ///< Set DNS family preference.
   static const char *const OPT_PROTO_PREFIX;            ///< Transport layer protocols.
+  static const char *const OPT_CLIENT_MAX_PREFIX;       ///< Open connections per client.
+  static const char *const OPT_CLIENT_RATE_PREFIX;      ///< New connections per second per client.
 
   static Vec<self> &m_global; ///< Global ("default") data.
 
@@ -119,6 +119,8 @@ const char *const HttpProxyPort::OPT_OUTBOUND_IP_PREFIX = "ip-out";
 const char *const HttpProxyPort::OPT_INBOUND_IP_PREFIX  = "ip-in";
 const char *const HttpProxyPort::OPT_HOST_RES_PREFIX    = "ip-resolve";
 const char *const HttpProxyPort::OPT_PROTO_PREFIX       = "proto";
+const char *const HttpProxyPort::OPT_CLIENT_MAX_PREFIX  = "client-max";
+const char *const HttpProxyPort::OPT_CLIENT_RATE_PREFIX = "client-rate";
 
 const char *const HttpProxyPort::OPT_IPV6                    = "ipv6";
 const char *const HttpProxyPort::OPT_IPV4                    = "ipv4";
@@ -140,6 +142,8 @@ size_t const OPT_OUTBOUND_IP_PREFIX_LEN = strlen(HttpProxyPort::OPT_OUTBOUND_IP_
 size_t const OPT_INBOUND_IP_PREFIX_LEN  = strlen(HttpProxyPort::OPT_INBOUND_IP_PREFIX);
 size_t const OPT_HOST_RES_PREFIX_LEN    = strlen(HttpProxyPort::OPT_HOST_RES_PREFIX);
 size_t const OPT_PROTO_PREFIX_LEN       = strlen(HttpProxyPort::OPT_PROTO_PREFIX);
+size_t const OPT_CLIENT_MAX_PREFIX_LEN  = strlen(HttpProxyPort::OPT_CLIENT_MAX_PREFIX);
+size_t const OPT_CLIENT_RATE_PREFIX_LEN = strlen(HttpProxyPort::OPT_CLIENT_RATE_PREFIX);
 }
 
 namespace
@@ -160,7 +164,9 @@ HttpProxyPort::HttpProxyPort()
     m_family(AF_INET),
     m_inbound_transparent_p(false),
     m_outbound_transparent_p(false),
-    m_transparent_passthrough(false)
+    m_transparent_passthrough(false),
+    m_client_max_connections(-1),
+    m_client_connection_rate(-1)
 {
   memcpy(m_host_res_preference, host_res_default_preference_order, sizeof(m_host_res_preference));
 }
@@ -377,6 +383,22 @@ HttpProxyPort::processOptions(const char *opts)
     } else if (nullptr != (value = this->checkPrefix(item, OPT_PROTO_PREFIX, OPT_PROTO_PREFIX_LEN))) {
       this->processSessionProtocolPreference(value);
       sp_set_p = true;
+    } else if (nullptr != (value = this->checkPrefix(item, OPT_CLIENT_MAX_PREFIX, OPT_CLIENT_MAX_PREFIX_LEN))) {
+      char *ptr; // tmp for syntax check.
+      int max = strtol(value, &ptr, 10);
+      if (ptr == value || max < 0) {
+        Warning("Mangled client connection limit '%s' in port descriptor '%s'", item, opts);
+      } else {
+        m_client_max_connections = max;
+      }
+    } else if (nullptr != (value = this->checkPrefix(item, OPT_CLIENT_RATE_PREFIX, OPT_CLIENT_RATE_PREFIX_LEN))) {
+      char *ptr; // tmp for syntax check.
+      int rate = strtol(value, &ptr, 10);
+      if (ptr == value || rate < 0) {
+        Warning("Mangled client connection rate '%s' in port descriptor '%s'", item, opts);
+      } else {
+        m_client_connection_rate = rate;
+      }
     } else {
       Warning("Invalid option '%s' in proxy port descriptor '%s'", item, opts);
     }
@@ -552,6 +574,13 @@ HttpProxyPort::print(char *out, size_t n)
     zret += snprintf(out + zret, n - zret, ":%s", OPT_TRANSPARENT_PASSTHROUGH);
   }
 
+  if (m_client_max_connections >= 0) {
+    zret += snprintf(out + zret, n - zret, ":%s=%d", OPT_CLIENT_MAX_PREFIX, m_client_max_connections);
+  }
+  if (m_client_connection_rate >= 0) {
+    zret += snprintf(out + zret, n - zret, ":%s=%d", OPT_CLIENT_RATE_PREFIX, m_client_connection_rate);
+  }
+
   /* Don't print the IP resolution preferences if the port is outbound
    * transparent (which means the preference order is forced) or if
    * the order is the same as the default.
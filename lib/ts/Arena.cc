@@ -157,3 +157,17 @@ Arena::reset()
   }
   ink_assert(m_blocks == nullptr);
 }
+
+/*-------------------------------------------------------------------------
+  -------------------------------------------------------------------------*/
+
+size_t
+Arena::allocated_size() const
+{
+  size_t size = 0;
+
+  for (ArenaBlock *b = m_blocks; b; b = b->next) {
+    size += b->m_heap_end - &b->data[0];
+  }
+  return size;
+}
@@ -49,6 +49,9 @@ public:
 
   inkcoreapi void reset();
 
+  /// Total size of the blocks held, used or not.
+  size_t allocated_size() const;
+
 private:
   ArenaBlock *m_blocks;
 };
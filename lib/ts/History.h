@@ -30,10 +30,20 @@
 #define NO_EVENT NO_REENTRANT
 #define HISTORY_DEFAULT_SIZE 65
 
+// The location is stored field by field so that event and reentrancy fit in
+// the padding after the line number; each HttpSM embeds a full History.
 struct HistoryEntry {
-  SourceLocation location;
+  const char *file     = nullptr;
+  const char *func     = nullptr;
+  int line             = 0;
   unsigned short event = 0;
   short reentrancy     = 0;
+
+  SourceLocation
+  location() const
+  {
+    return SourceLocation(file, func, line);
+  }
 };
 
 template <unsigned Count> class History
@@ -47,7 +57,9 @@ public:
     }
 
     int pos                 = history_pos++ % Count;
-    history[pos].location   = location;
+    history[pos].file       = location.file;
+    history[pos].func       = location.func;
+    history[pos].line       = location.line;
     history[pos].event      = (unsigned short)event;
     history[pos].reentrancy = (short)reentrant;
   }
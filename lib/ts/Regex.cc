@@ -24,6 +24,7 @@
 #include "ts/ink_platform.h"
 #include "ts/ink_thread.h"
 #include "ts/ink_memory.h"
+#include "ts/ParseRules.h"
 #include "ts/Regex.h"
 
 #ifdef PCRE_CONFIG_JIT
@@ -136,6 +137,228 @@ Regex::~Regex()
   }
 }
 
+std::string
+regex_required_literal(const char *pattern)
+{
+  std::string best, run;
+  int depth         = 0;
+  bool last_literal = false; // the previous top-level atom is the last character of run
+
+  auto end_run = [&]() {
+    if (run.size() > best.size()) {
+      best = run;
+    }
+    run.clear();
+  };
+
+  // Inline options and quoting change the meaning of what follows
+  if (strstr(pattern, "\\Q")) {
+    return std::string();
+  }
+  for (const char *p = strstr(pattern, "(?"); p; p = strstr(p + 2, "(?")) {
+    if (strchr("imsxJUX-", p[2])) {
+      return std::string();
+    }
+  }
+
+  for (const char *p = pattern; *p; ++p) {
+    bool literal = false;
+    int min      = -1; // minimum count of a quantifier, -1 if *p is not one
+
+    switch (*p) {
+    case '\\':
+      if (!*++p) {
+        return std::string();
+      }
+      // Escaped punctuation stands for itself. Of the letters, follow only the single
+      // character classes and anchors, the rest take arguments (\x41, \p{L}, \1 ...)
+      if (depth == 0) {
+        if (!ParseRules::is_alnum(*p)) {
+          run += *p;
+          literal = true;
+        } else if (strchr("dDwWsSbBhHvVRAzZGntrfe", *p)) {
+          end_run();
+        } else {
+          return std::string();
+        }
+      }
+      break;
+    case '[':
+      if (*++p == '^') {
+        ++p;
+      }
+      if (*p == ']') {
+        ++p;
+      }
+      for (; *p && *p != ']'; ++p) {
+        if (*p == '\\' && p[1]) {
+          ++p;
+        } else if (*p == '[' && p[1] && strchr(":=.", p[1])) {
+          // POSIX [:alpha:], [=e=] and [.x.] end with their own "x]", not the class's
+          const char delim[] = {p[1], ']', '\0'};
+          if (const char *close = strstr(p + 2, delim)) {
+            p = close + 1;
+          }
+        }
+      }
+      if (!*p) {
+        return std::string();
+      }
+      if (depth == 0) {
+        end_run();
+      }
+      break;
+    case '(':
+      if (depth++ == 0) {
+        end_run();
+      }
+      break;
+    case ')':
+      depth -= depth > 0;
+      break;
+    case '|':
+      if (depth == 0) {
+        return std::string();
+      }
+      break;
+    case '*':
+    case '?':
+      min = 0;
+      break;
+    case '+':
+      min = 1;
+      break;
+    case '{': {
+      // {n}, {n,} and {n,m} are quantifiers, and {,m} is one for newer PCRE. Anything else is a literal brace
+      const char *end = p + 1;
+      long n          = 0;
+      bool digits     = false;
+      for (; ParseRules::is_digit(*end); ++end) {
+        n      = n * 10 + (*end - '0');
+        digits = true;
+      }
+      if (*end == ',') {
+        for (++end; ParseRules::is_digit(*end); ++end) {
+          digits = true;
+        }
+      }
+      if (*end == '}' && digits) {
+        min = n > 0;
+        p   = end;
+        break;
+      }
+      if (depth == 0) {
+        run += '{';
+        literal = true;
+      }
+      break;
+    }
+    case '.':
+    case '^':
+    case '$':
+      if (depth == 0) {
+        end_run();
+      }
+      break;
+    default:
+      if (depth == 0) {
+        run += *p;
+        literal = true;
+      }
+      break;
+    }
+
+    if (min >= 0) {
+      if (depth == 0) {
+        // An optional character is not required, a repeated one ends the run
+        if (min == 0 && last_literal) {
+          run.pop_back();
+        }
+        end_run();
+      }
+      // Lazy and possessive forms
+      if (p[1] == '?' || p[1] == '+') {
+        ++p;
+      }
+    }
+    last_literal = literal;
+  }
+  end_run();
+
+  return best;
+}
+
+int
+RegexLiteralFilter::add(const char *pattern)
+{
+  std::string literal = regex_required_literal(pattern);
+
+  if (literal.empty()) {
+    return -1;
+  }
+  auto spot = _ids.find(literal);
+  if (spot != _ids.end()) {
+    return spot->second;
+  }
+  // Key the literal by its gram that the fewest other literals are keyed by.
+  int key = -1;
+  if (literal.size() >= GRAM_SIZE) {
+    _key_load.resize(GRAM_BUCKETS);
+    for (unsigned i = 0; i + GRAM_SIZE <= literal.size(); ++i) {
+      int bucket = gram_bucket(literal.data() + i);
+      if (key < 0 || _key_load[bucket] < _key_load[key]) {
+        key = bucket;
+      }
+    }
+    ++_key_load[key];
+  }
+
+  _literals.push_back(literal);
+  _keys.push_back(key);
+  _ids.emplace(literal, _literals.size() - 1);
+  return _literals.size() - 1;
+}
+
+int
+RegexLiteralFilter::gram_bucket(const char *s)
+{
+  uint32_t gram;
+
+  memcpy(&gram, s, sizeof(gram));
+  return (gram * 2654435761u) >> 20; // top 12 bits, GRAM_BUCKETS
+}
+
+bool
+RegexLiteralFilter::Scan::may_match(int id)
+{
+  if (id < 0) {
+    return true;
+  }
+  if (id < MEMO_SIZE && _searched[id]) {
+    return _found[id];
+  }
+
+  int key    = _filter._keys[id];
+  bool found = true;
+
+  if (key >= 0) {
+    if (!_hashed) {
+      _hashed = true;
+      for (const char *p = _subject; p[0] && p[1] && p[2] && p[3]; ++p) {
+        _grams[gram_bucket(p)] = true;
+      }
+    }
+    found = _grams[key];
+  }
+  found = found && strstr(_subject, _filter._literals[id].c_str()) != nullptr;
+
+  if (id < MEMO_SIZE) {
+    _searched[id] = true;
+    _found[id]    = found;
+  }
+  return found;
+}
+
 DFA::~DFA()
 {
   dfa_pattern *p = _my_patterns;
@@ -26,6 +26,11 @@
 
 #include "ts/ink_config.h"
 
+#include <bitset>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #ifdef HAVE_PCRE_PCRE_H
 #include <pcre/pcre.h>
 #else
@@ -55,6 +60,72 @@ private:
   pcre_extra *regex_extra;
 };
 
+/** Find a literal that every string matched by @a pattern contains.
+
+    This is the longest run of plain characters outside groups and
+    classes that no quantifier makes optional. A caller can look for it
+    with a plain substring search and skip the regex when it is absent.
+
+    @return The literal, empty if the pattern has none (e.g. top-level
+    alternation) or uses constructs the scan does not follow.
+*/
+std::string regex_required_literal(const char *pattern);
+
+/** Literal pre-filter for a list of regexes matched against the same subject.
+
+    Each regex is registered with add(), which returns the id of its required
+    literal or -1 if it has none. Regexes with the same literal share the id, so
+    a Scan searches the subject for each distinct literal at most once.
+
+    Each literal is also keyed by one of its GRAM_SIZE byte substrings, picked to
+    spread literals evenly over the hash buckets. A Scan hashes every such
+    substring of the subject into a bitmap, so most absent literals are rejected
+    with one bit test instead of a search, however many literals there are.
+*/
+class RegexLiteralFilter
+{
+public:
+  int add(const char *pattern);
+
+  int
+  size() const
+  {
+    return _literals.size();
+  }
+
+  static const int GRAM_SIZE    = 4;
+  static const int GRAM_BUCKETS = 4096;
+
+  /// The state for one subject, cheap enough to put on the stack for each lookup.
+  class Scan
+  {
+  public:
+    /// @a subject must be nul terminated and outlive the scan.
+    Scan(const RegexLiteralFilter &filter, const char *subject) : _filter(filter), _subject(subject) {}
+
+    /// False if a regex registered with literal @a id cannot match the subject.
+    bool may_match(int id);
+
+  private:
+    static const int MEMO_SIZE = 256; // literals with higher ids are searched for every time
+
+    const RegexLiteralFilter &_filter;
+    const char *_subject;
+    bool _hashed = false;
+    std::bitset<GRAM_BUCKETS> _grams; // buckets of every GRAM_SIZE substring of the subject
+    std::bitset<MEMO_SIZE> _searched;
+    std::bitset<MEMO_SIZE> _found;
+  };
+
+private:
+  static int gram_bucket(const char *s);
+
+  std::vector<std::string> _literals;
+  std::vector<int> _keys;     // key gram bucket of each literal, -1 if it is too short to have one
+  std::vector<int> _key_load; // number of literals keyed to each bucket
+  std::unordered_map<std::string, int> _ids; // literal -> index in _literals
+};
+
 typedef struct __pat {
   int _idx;
   Regex *_re;
@@ -57,10 +57,10 @@ REGRESSION_TEST(History_test)(RegressionTest *t, int /* atype ATS_UNUSED */, int
   tb.check(history[2].event == 3 && history[2].reentrancy == (short)NO_REENTRANT,
            "Checking that event is 3 and reentrancy is NO_REENTRANT");
 
-  tb.check(strncmp(history[0].location.str(buf, 128), "test_History.cc:51 (RegressionTest_History_test)",
+  tb.check(strncmp(history[0].location().str(buf, 128), "test_History.cc:51 (RegressionTest_History_test)",
                    strlen("test_History.cc:51 (RegressionTest_History_test)")) == 0,
            "Checking history string");
-  tb.check(strncmp(history[1].location.str(buf, 128), "test_History.cc:52 (RegressionTest_History_test)",
+  tb.check(strncmp(history[1].location().str(buf, 128), "test_History.cc:52 (RegressionTest_History_test)",
                    strlen("test_History.cc:52 (RegressionTest_History_test)")) == 0,
            "Checking history string");
 
@@ -69,10 +69,10 @@ REGRESSION_TEST(History_test)(RegressionTest *t, int /* atype ATS_UNUSED */, int
   SM_REMEMBER(sm, 2, 2);
   SM_REMEMBER(sm, 3, NO_REENTRANT);
 
-  tb.check(strncmp(sm->history[0].location.str(buf, 128), "test_History.cc:68 (RegressionTest_History_test)",
+  tb.check(strncmp(sm->history[0].location().str(buf, 128), "test_History.cc:68 (RegressionTest_History_test)",
                    strlen("test_History.cc:68 (RegressionTest_History_test)")) == 0,
            "Checking SM's history string");
-  tb.check(strncmp(sm->history[1].location.str(buf, 128), "test_History.cc:69 (RegressionTest_History_test)",
+  tb.check(strncmp(sm->history[1].location().str(buf, 128), "test_History.cc:69 (RegressionTest_History_test)",
                    strlen("test_History.cc:69 (RegressionTest_History_test)")) == 0,
            "Checking SM's history string");
 
@@ -95,11 +95,11 @@ REGRESSION_TEST(History_test)(RegressionTest *t, int /* atype ATS_UNUSED */, int
   tb.check(sm2->history.size() == 2, "Checking that history size is 2");
   tb.check(sm2->history.overflowed() == true, "Checking that history overflowed 4");
 
-  tb.check(strncmp(sm2->history[0].location.str(buf, 128), "test_History.cc:88 (RegressionTest_History_test)",
+  tb.check(strncmp(sm2->history[0].location().str(buf, 128), "test_History.cc:88 (RegressionTest_History_test)",
                    strlen("test_History.cc:88 (RegressionTest_History_test)")) == 0,
            "Checking history string");
 
-  tb.check(strncmp(sm2->history[1].location.str(buf, 128), "test_History.cc:91 (RegressionTest_History_test)",
+  tb.check(strncmp(sm2->history[1].location().str(buf, 128), "test_History.cc:91 (RegressionTest_History_test)",
                    strlen("test_History.cc:91 (RegressionTest_History_test)")) == 0,
            "Checking history string");
 
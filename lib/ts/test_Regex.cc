@@ -21,6 +21,7 @@
 
 #include "ts/ink_assert.h"
 #include "ts/ink_defs.h"
+#include "ts/ink_hrtime.h"
 #include "ts/Regex.h"
 #include "ts/TestBox.h"
 
@@ -55,3 +56,91 @@ REGRESSION_TEST(Regex_basic)(RegressionTest *t, int /* atype ATS_UNUSED */, int
     }
   }
 }
+
+static const struct {
+  const char *pattern;
+  const char *literal;
+} literal_data[] = {
+  {"(.*)\\.example\\.com", ".example.com"},
+  {"^www[0-9]+\\.cdn\\.net$", ".cdn.net"},
+  {"abc?defg", "defg"},
+  {"ab+cd", "ab"},
+  {"img{2}host", "host"},
+  {"a{,2}bc", "bc"},
+  {"x{y}z", "x{y}z"},
+  {"(foo|bar)\\.org", ".org"},
+  {"foo|barbaz", ""},
+  {"[a-z.]+-static\\.com", "-static.com"},
+  {"[[:digit:]]\\.cdn\\.net", ".cdn.net"},
+  {"[[:alnum:]]foo", "foo"},
+  {"[^[:alpha:][:digit:]]+\\.org", ".org"},
+  {"[[=e=]x]+yz", "yz"},
+  {"[[.-.]a]bc", "bc"},
+  {"[[]abc", "abc"},
+  {"\\d+origin\\w", "origin"},
+  {"(?i)host", ""},
+  {"(?:a|b)+\\.host", ".host"},
+  {"host\\x2e", ""},
+};
+
+REGRESSION_TEST(Regex_required_literal)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus, REGRESSION_TEST_PASSED);
+
+  for (auto const &test : literal_data) {
+    std::string literal = regex_required_literal(test.pattern);
+    box.check(literal == test.literal, "Pattern: %s Literal: \"%s\" expected \"%s\"", test.pattern, literal.c_str(),
+              test.literal);
+  }
+}
+
+// Host regexes of the kind found in remap.config regex_map rules, matched against
+// hosts most of which miss all of them, with and without the literal pre-filter
+REGRESSION_TEST(Regex_literal_filter)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus, REGRESSION_TEST_PASSED);
+  const int n_patterns = 300;
+  const int n_hosts    = 200;
+
+  std::vector<Regex> regexes(n_patterns);
+  std::vector<int> ids;
+  RegexLiteralFilter filter;
+  char buf[128];
+  for (int i = 0; i < n_patterns; ++i) {
+    snprintf(buf, sizeof(buf), (i % 3) ? "(.*)\\.site%d\\.example\\.com" : "^img[0-9]+\\.cdn%d\\.net$", i);
+    regexes[i].compile(buf);
+    ids.push_back(filter.add(buf));
+  }
+  box.check(filter.size() == n_patterns, "%d distinct literals for %d patterns", filter.size(), n_patterns);
+
+  std::vector<std::string> hosts;
+  for (int i = 0; i < n_hosts; ++i) {
+    snprintf(buf, sizeof(buf), (i % 10 == 0) ? "www.site%d.example.com" : (i % 10 == 1) ? "img7.cdn%d.net" : "origin%d.example.org",
+             i);
+    hosts.emplace_back(buf);
+  }
+
+  int matched[2] = {0, 0};
+  ink_hrtime elapsed[2];
+  for (int filtered = 0; filtered < 2; ++filtered) {
+    ink_hrtime start = ink_get_hrtime_internal();
+    for (auto const &host : hosts) {
+      RegexLiteralFilter::Scan scan(filter, host.c_str());
+      for (int i = 0; i < n_patterns; ++i) {
+        if (filtered && !scan.may_match(ids[i])) {
+          continue;
+        }
+        if (regexes[i].exec(host.c_str(), host.length())) {
+          ++matched[filtered];
+          break;
+        }
+      }
+    }
+    elapsed[filtered] = ink_get_hrtime_internal() - start;
+  }
+  box.check(matched[0] == matched[1], "%d hosts match through the filter, %d without", matched[1], matched[0]);
+  rprintf(t, "%d lookups over %d regexes: %.0f/s with the literal filter, %.0f/s without\n", n_hosts, n_patterns,
+          static_cast<double>(n_hosts) * HRTIME_SECOND / (elapsed[1] ? elapsed[1] : 1),
+          static_cast<double>(n_hosts) * HRTIME_SECOND / (elapsed[0] ? elapsed[0] : 1));
+  rperf(t, "lookups_per_sec", static_cast<double>(n_hosts) * HRTIME_SECOND / (elapsed[1] ? elapsed[1] : 1));
+}
@@ -40,6 +40,7 @@
 #include "HttpConfig.h"
 #include "P_Cache.h"
 #include "ts/Regex.h"
+#include "ts/TestBox.h"
 
 static const char modulePrefix[] = "[CacheControl]";
 
@@ -442,3 +443,101 @@ CacheControlRecord::UpdateMatch(CacheControlResult *result, RequestData *rdata)
     Debug("cache_control", "Matched with for %s at line %d%s", CC_directive_str[this->directive], this->line_num, crtc_debug);
   }
 }
+
+// Match requests against a cache.config the size large CDN deployments use, half
+// domain rules and half URL regexes, and check each request gets the rule it should.
+REGRESSION_TEST(CacheControl_LargeTable)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus, REGRESSION_TEST_PASSED);
+  const int n_rules    = 50000;
+  const int n_requests = 2000;
+  std::string config;
+  char buf[256];
+
+  // Line i + 1 holds rule i. The last line holds a regex with a POSIX character class.
+  for (int i = 0; i < n_rules; ++i) {
+    if (i % 2) {
+      snprintf(buf, sizeof(buf), "url_regex=^http://[a-z]+\\.site%d\\.org/static/ ttl-in-cache=1h\n", i);
+    } else {
+      snprintf(buf, sizeof(buf), "dest_domain=d%d.example.com ttl-in-cache=1h\n", i);
+    }
+    config += buf;
+  }
+  config += "url_regex=^http://[[:alnum:]]+\\.posix\\.org/ ttl-in-cache=1h\n";
+
+  CC_table table("", "CacheControl Unit Test Table", &http_dest_tags,
+                 ALLOW_HOST_TABLE | ALLOW_REGEX_TABLE | ALLOW_URL_TABLE | ALLOW_IP_TABLE | DONT_BUILD_TABLE);
+  ats_scoped_str file_buf(ats_strdup(config.c_str()));
+  ink_hrtime start = ink_get_hrtime_internal();
+  int n_entries    = table.BuildTableFromString(file_buf);
+  ink_hrtime build = ink_get_hrtime_internal() - start;
+  box.check(n_entries == n_rules + 1, "%d of %d rules loaded", n_entries, n_rules + 1);
+
+  // Returns the line of the ttl rule matching a GET of http://host/path
+  ink_hrtime elapsed = 0;
+  auto match_line    = [&](char *host, const char *path) {
+    HTTPParser parser;
+    HTTPHdr hdr;
+    HttpRequestData rdata;
+    CacheControlResult result;
+    const char *start_p = buf;
+
+    snprintf(buf, sizeof(buf), "GET http://%s%s HTTP/1.1\r\n\r\n", host, path);
+    hdr.create(HTTP_TYPE_REQUEST);
+    http_parser_init(&parser);
+    hdr.parse_req(&parser, &start_p, buf + strlen(buf), true);
+    http_parser_clear(&parser);
+    rdata.hdr          = &hdr;
+    rdata.hostname_str = host;
+
+    ink_hrtime match_start = ink_get_hrtime_internal();
+    table.Match(&rdata, &result);
+    elapsed += ink_get_hrtime_internal() - match_start;
+    hdr.destroy();
+    return result.ttl_line;
+  };
+
+  int wrong = 0;
+  for (int j = 0; j < n_requests; ++j) {
+    // Cycle through a domain hit, a regex hit and a miss.
+    int rule = (j * 7919) % n_rules;
+    char host[64];
+    const char *path;
+    int expected;
+
+    switch (j % 3) {
+    case 0:
+      rule &= ~1;
+      snprintf(host, sizeof(host), "www.d%d.example.com", rule);
+      path     = "/index.html";
+      expected = rule + 1;
+      break;
+    case 1:
+      rule |= 1;
+      snprintf(host, sizeof(host), "img.site%d.org", rule);
+      path     = "/static/logo.png";
+      expected = rule + 1;
+      break;
+    default:
+      snprintf(host, sizeof(host), "img.site%d.org", rule);
+      path     = "/dynamic/logo.png";
+      expected = -1;
+      break;
+    }
+
+    int line = match_line(host, path);
+    if (line != expected) {
+      if (wrong++ < 5) {
+        rprintf(t, "%s matched line %d, expected %d\n", host, line, expected);
+      }
+    }
+  }
+
+  char posix_host[] = "img7.posix.org";
+  int line           = match_line(posix_host, "/logo.png");
+  box.check(line == n_rules + 1, "%s matched line %d, expected %d", posix_host, line, n_rules + 1);
+  box.check(wrong == 0, "%d of %d requests matched the wrong rule", wrong, n_requests);
+  rprintf(t, "%d rules built in %" PRId64 "ms, %.0f lookups/s\n", n_rules, ink_hrtime_to_msec(build),
+          static_cast<double>(n_requests) * HRTIME_SECOND / (elapsed ? elapsed : 1));
+  rperf(t, "lookups_per_sec", static_cast<double>(n_requests) * HRTIME_SECOND / (elapsed ? elapsed : 1));
+}
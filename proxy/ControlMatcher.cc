@@ -342,7 +342,6 @@ void
 UrlMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
 {
   char *url_str;
-  int *value;
 
   // Check to see there is any work to before we copy the
   //   URL
@@ -351,19 +350,25 @@ UrlMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
   }
 
   url_str = rdata->get_string();
+  Match(url_str ? url_str : "", rdata, result);
+  ats_free(url_str);
+}
 
-  // Can't do a regex match with a NULL string so
-  //  use an empty one instead
-  if (url_str == nullptr) {
-    url_str = ats_strdup("");
-  }
+//
+// void UrlMatcher<Data,MatchResult>::Match(const char* url_str, RD* rdata, MatchResult* result)
+//
+//   As above, for a URL string the caller already has from rdata
+//
+template <class Data, class MatchResult>
+void
+UrlMatcher<Data, MatchResult>::Match(const char *url_str, RequestData *rdata, MatchResult *result)
+{
+  int *value;
 
   if (ink_hash_table_lookup(url_ht, url_str, (void **)&value)) {
     Debug("matcher", "%s Matched %s with url at line %d", matcher_name, url_str, data_array[*value].line_num);
     data_array[*value].UpdateMatch(result, rdata);
   }
-
-  ats_free(url_str);
 }
 
 //
@@ -384,6 +389,7 @@ template <class Data, class MatchResult> RegexMatcher<Data, MatchResult>::~Regex
     ats_free(re_str[i]);
   }
   delete[] re_str;
+  delete[] re_literal;
   ats_free(re_array);
 }
 
@@ -421,6 +427,8 @@ RegexMatcher<Data, MatchResult>::AllocateSpace(int num_entries)
   re_str = new char *[num_entries];
   memset(re_str, 0, sizeof(char *) * num_entries);
 
+  re_literal = new int[num_entries];
+
   array_len = num_entries;
   num_el    = 0;
 }
@@ -473,6 +481,7 @@ RegexMatcher<Data, MatchResult>::NewEntry(matcher_line *line_info)
     pcre_free(re_array[num_el]);
     re_array[num_el] = nullptr;
   } else {
+    re_literal[num_el] = re_filter.add(pattern);
     num_el++;
   }
 
@@ -490,7 +499,6 @@ void
 RegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
 {
   char *url_str;
-  int r;
 
   // Check to see there is any work to before we copy the
   //   URL
@@ -502,25 +510,41 @@ RegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
 
   // Can't do a regex match with a NULL string so
   //  use an empty one instead
-  if (url_str == nullptr) {
-    url_str = ats_strdup("");
-  }
   // INKqa12980
   // The function unescapifyStr() is already called in
   // HttpRequestData::get_string(); therefore, no need to call again here.
   // unescapifyStr(url_str);
+  Match(url_str ? url_str : "", rdata, result);
+  ats_free(url_str);
+}
+
+//
+// void RegexMatcher<Data,MatchResult>::Match(const char* subject, RequestData* rdata, MatchResult* result)
+//
+//   Runs each regex against arg subject, skipping the ones whose
+//     required literal is not in it
+//
+template <class Data, class MatchResult>
+void
+RegexMatcher<Data, MatchResult>::Match(const char *subject, RequestData *rdata, MatchResult *result)
+{
+  RegexLiteralFilter::Scan literal_scan(re_filter, subject);
+  int len = strlen(subject);
+  int r;
 
   for (int i = 0; i < num_el; i++) {
-    r = pcre_exec(re_array[i], nullptr, url_str, strlen(url_str), 0, 0, nullptr, 0);
+    if (!literal_scan.may_match(re_literal[i])) {
+      continue;
+    }
+    r = pcre_exec(re_array[i], nullptr, subject, len, 0, 0, nullptr, 0);
     if (r > -1) {
-      Debug("matcher", "%s Matched %s with regex at line %d", matcher_name, url_str, data_array[i].line_num);
+      Debug("matcher", "%s Matched %s with regex at line %d", matcher_name, subject, data_array[i].line_num);
       data_array[i].UpdateMatch(result, rdata);
     } else if (r < -1) {
       // An error has occured
       Warning("Error [%d] matching regex at line %d.", r, data_array[i].line_num);
     } // else it's -1 which means no match was found.
   }
-  ats_free(url_str);
 }
 
 //
@@ -543,7 +567,6 @@ void
 HostRegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
 {
   const char *url_str;
-  int r;
 
   // Check to see there is any work to before we copy the
   //   URL
@@ -558,17 +581,7 @@ HostRegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *resu
   if (url_str == nullptr) {
     url_str = "";
   }
-  for (int i = 0; i < this->num_el; i++) {
-    r = pcre_exec(this->re_array[i], nullptr, url_str, strlen(url_str), 0, 0, nullptr, 0);
-    if (r != -1) {
-      Debug("matcher", "%s Matched %s with regex at line %d", const_cast<char *>(this->matcher_name), url_str,
-            this->data_array[i].line_num);
-      this->data_array[i].UpdateMatch(result, rdata);
-    } else {
-      // An error has occured
-      Warning("error matching regex at line %d", this->data_array[i].line_num);
-    }
-  }
+  RegexMatcher<Data, MatchResult>::Match(url_str, rdata, result);
 }
 
 //
@@ -755,10 +768,16 @@ ControlMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result
   if (hostMatch != nullptr) {
     hostMatch->Match(rdata, result);
   }
-  if (reMatch != nullptr) {
+  // The regex and url tables both match against the unescaped URL, so only build it once.
+  if (reMatch != nullptr && urlMatch != nullptr) {
+    char *url_str = rdata->get_string();
+
+    reMatch->Match(url_str ? url_str : "", rdata, result);
+    urlMatch->Match(url_str ? url_str : "", rdata, result);
+    ats_free(url_str);
+  } else if (reMatch != nullptr) {
     reMatch->Match(rdata, result);
-  }
-  if (urlMatch != nullptr) {
+  } else if (urlMatch != nullptr) {
     urlMatch->Match(rdata, result);
   }
   if (ipMatch != nullptr) {
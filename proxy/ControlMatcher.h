@@ -193,6 +193,7 @@ public:
   UrlMatcher(const char *name, const char *filename);
   ~UrlMatcher();
   void Match(RequestData *rdata, MatchResult *result);
+  void Match(const char *url_str, RequestData *rdata, MatchResult *result);
   void AllocateSpace(int num_entries);
   Result NewEntry(matcher_line *line_info);
   void Print();
@@ -217,6 +218,7 @@ public:
   RegexMatcher(const char *name, const char *filename);
   ~RegexMatcher();
   void Match(RequestData *rdata, MatchResult *result);
+  void Match(const char *subject, RequestData *rdata, MatchResult *result);
   void AllocateSpace(int num_entries);
   Result NewEntry(matcher_line *line_info);
   void Print();
@@ -230,6 +232,8 @@ public:
 protected:
   pcre **re_array = nullptr; // array of compiled regexs
   char **re_str   = nullptr; // array of uncompiled regex strings
+  int *re_literal = nullptr; // array of required literal ids in re_filter
+  RegexLiteralFilter re_filter;
 };
 
 template <class Data, class MatchResult> class HostRegexMatcher : public RegexMatcher<Data, MatchResult>
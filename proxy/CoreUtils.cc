@@ -700,7 +700,7 @@ CoreUtils::dump_history(HttpSM *hsm)
     char loc[256];
     int r          = (int)hsm->history[i].reentrancy;
     int e          = (int)hsm->history[i].event;
-    char *fileline = load_string(hsm->history[i].location.str(loc, sizeof(loc)));
+    char *fileline = load_string(hsm->history[i].location().str(loc, sizeof(loc)));
 
     fileline = (fileline != nullptr) ? fileline : ats_strdup("UNKNOWN");
 
@@ -7656,8 +7656,12 @@ TSHttpTxnServerPush(TSHttpTxn txnp, const char *url, int url_len)
 
   HttpSM *sm          = reinterpret_cast<HttpSM *>(txnp);
   Http2Stream *stream = dynamic_cast<Http2Stream *>(sm->ua_session);
-  if (stream) {
+  // The connection state belongs to the session thread, a transaction running on another thread does not push
+  if (stream && !stream->is_sm_distributed()) {
     Http2ClientSession *parent = static_cast<Http2ClientSession *>(stream->get_parent());
+    // The diary has the URLs in the form the client requests are printed in
+    char buf[2048];
+    url = url_obj.string_get_buf(buf, sizeof(buf), &url_len);
     if (!parent->is_url_pushed(url, url_len)) {
       HTTPHdr *hptr = &(sm->t_state.hdr_info.client_request);
       TSMLoc obj    = reinterpret_cast<TSMLoc>(hptr->m_http);
@@ -7667,6 +7671,8 @@ TSHttpTxnServerPush(TSHttpTxn txnp, const char *url, int url_len)
       stream->push_promise(url_obj, f);
 
       parent->add_url_to_pushed_table(url, url_len);
+    } else {
+      HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_PUSH_SKIPPED_COUNT, this_ethread());
     }
   }
   url_obj.destroy();
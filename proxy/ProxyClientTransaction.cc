@@ -57,6 +57,12 @@ ProxyClientTransaction::new_transaction()
     current_reader->plugin_id  = pi->getPluginId();
   }
 
+  this->start_transaction();
+}
+
+void
+ProxyClientTransaction::start_transaction()
+{
   current_reader->attach_client_session(this, sm_reader);
 }
 
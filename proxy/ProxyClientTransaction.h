@@ -52,7 +52,7 @@ public:
 
   // See if we need to schedule on the primary thread for the transaction or change the thread that is associated with the VC.
   // If we reschedule, the scheduled action is returned.  Otherwise, NULL is returned
-  Action *adjust_thread(Continuation *cont, int event, void *data);
+  virtual Action *adjust_thread(Continuation *cont, int event, void *data);
 
   int
   get_transact_count() const
@@ -73,7 +73,7 @@ public:
     return parent ? parent->is_transparent_passthrough_allowed() : false;
   }
 
-  void
+  virtual void
   set_half_close_flag(bool flag)
   {
     if (parent)
@@ -257,6 +257,9 @@ public:
   virtual int get_transaction_id() const = 0;
 
 protected:
+  // Attaches the SM allocated by new_transaction, a subclass may start it elsewhere
+  virtual void start_transaction();
+
   ProxyClientSession *parent;
   HttpSM *current_reader;
   IOBufferReader *sm_reader;
@@ -59,6 +59,43 @@ remap_plugin_info *remap_pi_list; // We never reload the remap plugins, just app
 #define URL_REMAP_MODE_CHANGED 8
 #define HTTP_DEFAULT_REDIRECT_CHANGED 9
 
+/** Current resident set size of the process in bytes, or -1 where it cannot be read. */
+static int64_t
+current_rss()
+{
+  int64_t rss = -1;
+#if defined(linux)
+  if (FILE *fp = fopen("/proc/self/statm", "r")) {
+    long size, resident;
+    if (fscanf(fp, "%ld %ld", &size, &resident) == 2) {
+      rss = static_cast<int64_t>(resident) * ats_pagesize();
+    }
+    fclose(fp);
+  }
+#endif
+  return rss;
+}
+
+/**
+  Build a new rewrite table from remap.config, recording how long that took and how much the
+  resident set size of the process grew while building it.
+*/
+static UrlRewrite *
+build_url_rewrite()
+{
+  int64_t rss_before = current_rss();
+  ink_hrtime start   = ink_get_hrtime_internal();
+  UrlRewrite *table  = new UrlRewrite();
+
+  RecSetRecordInt("proxy.process.url_remap.reload_time", ink_hrtime_to_msec(ink_get_hrtime_internal() - start), REC_SOURCE_DEFAULT);
+  int64_t rss_after = current_rss();
+  if (rss_before >= 0 && rss_after >= 0) {
+    RecSetRecordInt("proxy.process.url_remap.reload_memory", std::max<int64_t>(rss_after - rss_before, 0), REC_SOURCE_DEFAULT);
+  }
+
+  return table;
+}
+
 //
 // Begin API Functions
 //
@@ -67,8 +104,11 @@ int
 init_reverse_proxy()
 {
   ink_assert(rewrite_table == nullptr);
+  RecRegisterStatInt(RECT_PROCESS, "proxy.process.url_remap.reload_time", static_cast<RecInt>(0), RECP_NON_PERSISTENT);
+  RecRegisterStatInt(RECT_PROCESS, "proxy.process.url_remap.reload_memory", static_cast<RecInt>(0), RECP_NON_PERSISTENT);
+
   reconfig_mutex = new_ProxyMutex();
-  rewrite_table  = new UrlRewrite();
+  rewrite_table  = build_url_rewrite();
 
   if (!rewrite_table->is_valid()) {
     Fatal("unable to load remap.config");
@@ -132,7 +172,7 @@ reloadUrlRewrite()
   UrlRewrite *newTable;
 
   Debug("url_rewrite", "remap.config updated, reloading...");
-  newTable = new UrlRewrite();
+  newTable = build_url_rewrite();
   if (newTable->is_valid()) {
     new_Deleter(rewrite_table, URL_REWRITE_TIMEOUT);
     static const char *msg = "remap.config done reloading!";
@@ -337,6 +337,7 @@ http_hdr_copy_onto(HTTPHdrImpl *s_hh, HdrHeap *s_heap, HTTPHdrImpl *d_hh, HdrHea
 
   memcpy(d_hh, s_hh, sizeof(HTTPHdrImpl));
   d_hh->m_fields_impl = d_mh; // restore pre-memcpy mime impl
+  hdr_heap_counters.bytes_copied += sizeof(HTTPHdrImpl);
 
   if (s_hh->m_polarity == HTTP_TYPE_REQUEST) {
     if (d_polarity == HTTP_TYPE_REQUEST) {
@@ -920,9 +921,13 @@ http_parser_parse_req(HTTPParser *parser, HdrHeap *heap, HTTPHdrImpl *hh, const
     must_copy_strings = (must_copy_strings || (!line_is_real));
 
 #if (ENABLE_PARSER_FAST_PATHS)
-    // first try fast path
+    // first try fast path, "METHOD SP url SP HTTP/d.d CRLF" with a method of at most 7 token characters
     if (end - cur >= 16) {
-      if (((cur[0] ^ 'G') | (cur[1] ^ 'E') | (cur[2] ^ 'T')) != 0) {
+      int method_len = 0;
+      while (method_len < 8 && ParseRules::is_token(cur[method_len])) {
+        ++method_len;
+      }
+      if (method_len == 0 || method_len == 8) {
         goto slow_case;
       }
       if (((end[-10] ^ 'H') | (end[-9] ^ 'T') | (end[-8] ^ 'T') | (end[-7] ^ 'P') | (end[-6] ^ '/') | (end[-4] ^ '.') |
@@ -932,20 +937,26 @@ http_parser_parse_req(HTTPParser *parser, HdrHeap *heap, HTTPHdrImpl *hh, const
       if (!(is_digit(end[-5]) && is_digit(end[-3]))) {
         goto slow_case;
       }
-      if (!(ParseRules::is_space(cur[3]) && (!ParseRules::is_space(cur[4])) && (!ParseRules::is_space(end[-12])) &&
-            ParseRules::is_space(end[-11]))) {
+      if (!(ParseRules::is_space(cur[method_len]) && (!ParseRules::is_space(cur[method_len + 1])) &&
+            (!ParseRules::is_space(end[-12])) && ParseRules::is_space(end[-11]))) {
         goto slow_case;
       }
-      if (&(cur[4]) >= &(end[-11])) {
+      if (&(cur[method_len + 1]) >= &(end[-11])) {
         goto slow_case;
       }
 
       int32_t version = HTTP_VERSION(end[-5] - '0', end[-3] - '0');
+      int method_wks_idx;
 
-      http_hdr_method_set(heap, hh, &(cur[0]), hdrtoken_wks_to_index(HTTP_METHOD_GET), 3, must_copy_strings);
+      if (method_len == 3 && ((cur[0] ^ 'G') | (cur[1] ^ 'E') | (cur[2] ^ 'T')) == 0) {
+        method_wks_idx = hdrtoken_wks_to_index(HTTP_METHOD_GET);
+      } else {
+        method_wks_idx = hdrtoken_tokenize(cur, method_len);
+      }
+      http_hdr_method_set(heap, hh, &(cur[0]), method_wks_idx, method_len, must_copy_strings);
       ink_assert(hh->u.req.m_url_impl != nullptr);
       url       = hh->u.req.m_url_impl;
-      url_start = &(cur[4]);
+      url_start = &(cur[method_len + 1]);
       err       = ::url_parse(heap, url, &url_start, &(end[-11]), must_copy_strings, strict_uri_parsing);
       if (err < 0) {
         return err;
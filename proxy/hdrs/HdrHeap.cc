@@ -44,6 +44,8 @@ static HdrHeap proto_heap;
 
 Allocator strHeapAllocator("hdrStrHeap", HDR_STR_HEAP_DEFAULT_SIZE);
 
+thread_local HdrHeapCounters hdr_heap_counters;
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -129,6 +131,7 @@ new_HdrHeap(int size)
 
   h->m_size = size;
   h->init();
+  hdr_heap_counters.bytes_allocated += size;
 
   return h;
 }
@@ -160,6 +163,7 @@ new_HdrStrHeap(int requested_size)
   sh->m_heap_size  = alloc_size;
   sh->m_free_size  = alloc_size - STR_HEAP_HDR_SIZE;
   sh->m_free_start = ((char *)sh) + STR_HEAP_HDR_SIZE;
+  hdr_heap_counters.bytes_allocated += alloc_size;
 
   ink_assert(sh->refcount() == 0);
 
@@ -316,6 +320,7 @@ HdrHeap::duplicate_str(const char *str, int nbytes)
   char *new_str = allocate_str(nbytes);
 
   memcpy(new_str, str, nbytes);
+  hdr_heap_counters.bytes_copied += nbytes;
   return (new_str);
 }
 
@@ -364,11 +369,13 @@ HdrHeap::coalesce_str_heaps(int incoming_size)
   ink_assert(incoming_size >= 0);
   ink_assert(m_writeable);
 
-  new_heap_size += required_space_for_evacuation();
+  size_t evacuated = required_space_for_evacuation();
+  new_heap_size += evacuated;
 
   HdrStrHeap *new_heap = new_HdrStrHeap(new_heap_size);
   evacuate_from_str_heaps(new_heap);
   m_lost_string_space = 0;
+  hdr_heap_counters.bytes_copied += evacuated;
 
   // At this point none of the currently used string
   //  heaps are needed since everything is in the
@@ -968,12 +975,9 @@ HdrHeap::unmarshal(int buf_length, int obj_type, HdrHeapObjImpl **found_obj, Ref
 inline bool
 HdrHeap::attach_str_heap(char *h_start, int h_len, RefCountObj *h_ref_obj, int *index)
 {
-  if (*index >= HDR_BUF_RONLY_HEAPS) {
-    return false;
-  }
-
-  // Loop over existing entries to see if this one is already present
-  for (int z = 0; z < *index; z++) {
+  // Loop over existing entries to see if this one is already present.
+  //  That needs no free slot, so check it before the bound
+  for (int z = 0; z < HDR_BUF_RONLY_HEAPS; z++) {
     if (m_ronly_heap[z].m_heap_start == h_start) {
       ink_assert(m_ronly_heap[z].m_ref_count_ptr.object() == h_ref_obj);
 
@@ -988,6 +992,10 @@ HdrHeap::attach_str_heap(char *h_start, int h_len, RefCountObj *h_ref_obj, int *
     }
   }
 
+  if (*index >= HDR_BUF_RONLY_HEAPS) {
+    return false;
+  }
+
   m_ronly_heap[*index].m_ref_count_ptr = h_ref_obj;
   m_ronly_heap[*index].m_heap_start    = h_start;
   m_ronly_heap[*index].m_heap_len      = h_len;
@@ -1026,14 +1034,21 @@ HdrHeap::inherit_string_heaps(const HdrHeap *inherit_from)
     }
   }
 
-  // Find out if we have enough slots
+  // Find out if we have enough slots.  Heaps we already share with
+  //  inherit_from, as when the same header is copied onto us again,
+  //  take no new slot and bring no new lost space
+  int new_heaps = 0;
   if (inherit_from->m_read_write_heap) {
-    free_slots--;
+    if (!has_ronly_str_heap(((char *)inherit_from->m_read_write_heap.get()) + STR_HEAP_HDR_SIZE)) {
+      new_heaps++;
+    }
     inherit_str_size = inherit_from->m_read_write_heap->m_heap_size;
   }
   for (index = 0; index < HDR_BUF_RONLY_HEAPS; index++) {
     if (inherit_from->m_ronly_heap[index].m_heap_start != nullptr) {
-      free_slots--;
+      if (!has_ronly_str_heap(inherit_from->m_ronly_heap[index].m_heap_start)) {
+        new_heaps++;
+      }
       inherit_str_size += inherit_from->m_ronly_heap[index].m_heap_len;
     } else {
       // Heaps are allocated from the front of the array, so if
@@ -1041,9 +1056,10 @@ HdrHeap::inherit_string_heaps(const HdrHeap *inherit_from)
       break;
     }
   }
+  free_slots -= new_heaps;
 
   // Find out if we are building up too much lost space
-  int new_lost_space = m_lost_string_space + inherit_from->m_lost_string_space;
+  int new_lost_space = m_lost_string_space + (new_heaps ? inherit_from->m_lost_string_space : 0);
 
   if (free_slots < 0 || new_lost_space > (int)MAX_LOST_STR_SPACE) {
     // Not enough free slots.  We need to force a coalesce of
@@ -1070,7 +1086,7 @@ HdrHeap::inherit_string_heaps(const HdrHeap *inherit_from)
       }
     }
 
-    m_lost_string_space += inherit_from->m_lost_string_space;
+    m_lost_string_space = new_lost_space;
   }
 
   return;
@@ -267,6 +267,17 @@ public:
   size_t required_space_for_evacuation();
   bool attach_str_heap(char *h_start, int h_len, RefCountObj *h_ref_obj, int *index);
 
+  bool
+  has_ronly_str_heap(const char *h_start) const
+  {
+    for (const auto &i : m_ronly_heap) {
+      if (i.m_heap_start == h_start) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   /** Struct to prevent garbage collection on heaps.
       This bumps the reference count to the heap containing the pointer
       while the instance of this class exists. When it goes out of scope
@@ -479,5 +490,15 @@ HdrHeapSDKHandle::set(const HdrHeapSDKHandle *from)
 
 inkcoreapi HdrHeap *new_HdrHeap(int size = HDR_HEAP_DEFAULT_SIZE);
 
+/// Header heap traffic of the calling thread: memory taken for heaps and string heaps,
+/// and bytes copied between heaps by header copies, string duplication and coalescing.
+/// Callers take the difference across a piece of work to charge it.
+struct HdrHeapCounters {
+  int64_t bytes_allocated;
+  int64_t bytes_copied;
+};
+
+extern thread_local HdrHeapCounters hdr_heap_counters;
+
 void hdr_heap_test();
 #endif
@@ -22,31 +22,23 @@
  */
 
 #include "ts/ink_platform.h"
-#include "ts/HashFNV.h"
 #include "ts/Diags.h"
 #include "ts/ink_memory.h"
 #include <cstdio>
+#include <algorithm>
 #include "ts/Allocator.h"
 #include "HTTP.h"
 #include "HdrToken.h"
 #include "MIME.h"
-#include "ts/Regex.h"
 #include "URL.h"
 
-/*
- You SHOULD add to _hdrtoken_commonly_tokenized_strs, with the same ordering
- ** important, ordering matters **
-
- You want a regexp like 'Accept' after "greedier" choices so it doesn't match 'Accept-Ranges' earlier than
- it should. The regexp are anchored (^Accept), but I dont see a way with the current system to
- match the word ONLY without making _hdrtoken_strs a real PCRE, but then that breaks the hashing
- hdrtoken_hash("^Accept$") != hdrtoken_hash("Accept")
-
- So, the current hack is to have "Accept" follow "Accept-.*", lame, I know
-
-  /ericb
-*/
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
+// WARNING:  Indexes into this array are stored on disk for cached objects.  New strings must be added at the end of the array to
+// avoid changing the indexes of pre-existing entries, unless the cache format version number is increased.
+//
 static const char *_hdrtoken_strs[] = {
   // MIME Field names
   "Accept-Charset", "Accept-Encoding", "Accept-Language", "Accept-Ranges", "Accept", "Age", "Allow",
@@ -253,149 +245,173 @@ int32_t hdrtoken_str_slotids[SIZEOF(_hdrtoken_strs)];          // wks_idx -> slo
 uint64_t hdrtoken_str_masks[SIZEOF(_hdrtoken_strs)];           // wks_idx -> presence mask
 uint32_t hdrtoken_str_flags[SIZEOF(_hdrtoken_strs)];           // wks_idx -> flags
 
-DFA *hdrtoken_strs_dfa = nullptr;
-
 /***********************************************************************
  *                                                                     *
  *                        H A S H    T A B L E                         *
  *                                                                     *
  ***********************************************************************/
 
-#define HDRTOKEN_HASH_TABLE_SIZE 65536
-#define HDRTOKEN_HASH_TABLE_MASK HDRTOKEN_HASH_TABLE_SIZE - 1
+/*
+  The well-known strings are looked up through a perfect hash built once in
+  hdrtoken_init(): the name is case folded while it is hashed, the top bits
+  of the hash pick a group, and the group's displacement, chosen so that no
+  two strings share a slot, turns the rest of the hash into the only slot
+  that can hold the string.  Each slot keeps its string folded and
+  zero padded to HDRTOKEN_MAX_LENGTH bytes, so a hit costs one pass over
+  the name plus a fixed size compare.
+*/
+
+#define HDRTOKEN_MAX_LENGTH 32          // longest well-known string, with room to compare it in two 16 byte blocks
+#define HDRTOKEN_DISPLACEMENT_BITS 6    // 64 displacements, about two strings each
+#define HDRTOKEN_HASH_TABLE_MAX_SIZE 1024
 
 struct HdrTokenHashBucket {
+  char folded[HDRTOKEN_MAX_LENGTH]; // lower cased string, zero padded
   const char *wks;
-  uint32_t hash;
+  int length;
 };
 
-HdrTokenHashBucket hdrtoken_hash_table[HDRTOKEN_HASH_TABLE_SIZE];
+static HdrTokenHashBucket hdrtoken_hash_table[HDRTOKEN_HASH_TABLE_MAX_SIZE] __attribute__((aligned(16)));
+static uint32_t hdrtoken_hash_table_mask;
+static uint32_t hdrtoken_hash_displacements[1 << HDRTOKEN_DISPLACEMENT_BITS];
 
 /**
-  basic FNV hash
+  FNV-1a over the lower cased string, which is also copied to @a folded,
+  with a final mix so the middle bits depend on every byte.
 **/
-#define TINY_MASK(x) (((uint32_t)1 << (x)) - 1)
+static inline uint64_t
+hdrtoken_hash(const char *string, int length, char *folded)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+
+  for (int i = 0; i < length; ++i) {
+    folded[i] = ParseRules::ink_tolower(string[i]);
+    hash      = (hash ^ static_cast<unsigned char>(folded[i])) * 0x100000001b3ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+static inline uint32_t
+hdrtoken_hash_to_displacement(uint64_t hash)
+{
+  return hash >> (64 - HDRTOKEN_DISPLACEMENT_BITS);
+}
 
-inline uint32_t
-hash_to_slot(uint32_t hash)
+static inline uint32_t
+hdrtoken_hash_to_slot(uint64_t hash)
 {
-  return ((hash >> 15) ^ hash) & TINY_MASK(15);
+  uint32_t step = static_cast<uint32_t>(hash >> (32 - HDRTOKEN_DISPLACEMENT_BITS)) | 1;
+  return (static_cast<uint32_t>(hash) + hdrtoken_hash_displacements[hdrtoken_hash_to_displacement(hash)] * step) &
+         hdrtoken_hash_table_mask;
 }
 
-inline uint32_t
-hdrtoken_hash(const unsigned char *string, unsigned int length)
+static inline bool
+hdrtoken_folded_eq(const char *a, const char *b)
 {
-  ATSHash32FNV1a fnv;
-  fnv.update(string, length, ATSHash::nocase());
-  fnv.final();
-  return fnv.get();
+#if defined(__SSE2__)
+  __m128i lo = _mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(a)),
+                              _mm_load_si128(reinterpret_cast<const __m128i *>(b)));
+  __m128i hi = _mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(a + 16)),
+                              _mm_load_si128(reinterpret_cast<const __m128i *>(b + 16)));
+  return _mm_movemask_epi8(_mm_and_si128(lo, hi)) == 0xFFFF;
+#else
+  return memcmp(a, b, HDRTOKEN_MAX_LENGTH) == 0;
+#endif
 }
 
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
-// WARNING:  Indexes into this array are stored on disk for cached objects.  New strings must be added at the end of the array to
-// avoid changing the indexes of pre-existing entries, unless the cache format version number is increased.
-//
-static const char *_hdrtoken_commonly_tokenized_strs[] = {
-  // MIME Field names
-  "Accept-Charset", "Accept-Encoding", "Accept-Language", "Accept-Ranges", "Accept", "Age", "Allow",
-  "Approved", // NNTP
-  "Authorization",
-  "Bytes", // NNTP
-  "Cache-Control", "Client-ip", "Connection", "Content-Base", "Content-Encoding", "Content-Language", "Content-Length",
-  "Content-Location", "Content-MD5", "Content-Range", "Content-Type",
-  "Control", // NNTP
-  "Cookie", "Date",
-  "Distribution", // NNTP
-  "Etag", "Expect", "Expires",
-  "Followup-To", // NNTP
-  "From", "Host", "If-Match", "If-Modified-Since", "If-None-Match", "If-Range", "If-Unmodified-Since", "Keep-Alive",
-  "Keywords", // NNTP
-  "Last-Modified",
-  "Lines", // NNTP
-  "Location", "Max-Forwards",
-  "Message-ID", // NNTP
-  "MIME-Version",
-  "Newsgroups",   // NNTP
-  "Organization", // NNTP
-  "Path",         // NNTP
-  "Pragma", "Proxy-Authenticate", "Proxy-Authorization", "Proxy-Connection", "Public", "Range",
-  "References", // NNTP
-  "Referer",
-  "Reply-To", // NNTP
-  "Retry-After",
-  "Sender", // NNTP
-  "Server", "Set-Cookie",
-  "Subject", // NNTP
-  "Summary", // NNTP
-  "Transfer-Encoding", "Upgrade", "User-Agent", "Vary", "Via", "Warning", "Www-Authenticate",
-  "Xref",          // NNTP
-  "@Ats-Internal", // Internal Hack
-
-  // Accept-Encoding
-  "compress", "deflate", "gzip", "identity",
-
-  // Cache-Control flags
-  "max-age", "max-stale", "min-fresh", "must-revalidate", "no-cache", "no-store", "no-transform", "only-if-cached", "private",
-  "proxy-revalidate", "s-maxage", "need-revalidate-once",
-
-  // HTTP miscellaneous
-  "none", "chunked", "close",
-
-  // WS
-  "websocket", "Sec-WebSocket-Key", "Sec-WebSocket-Version",
-
-  // HTTP/2 cleartext
-  MIME_UPGRADE_H2C_TOKEN, "HTTP2-Settings",
-
-  // URL schemes
-  "file", "ftp", "gopher", "https", "http", "mailto", "news", "nntp", "prospero", "telnet", "tunnel", "wais", "pnm", "rtspu",
-  "rtsp", "mmsu", "mmst", "mms", "wss", "ws",
+// Places every well-known string in a table of @a size slots, returns false if some displacement group does not fit
+static bool
+hdrtoken_hash_build(uint32_t size)
+{
+  const int num_groups = 1 << HDRTOKEN_DISPLACEMENT_BITS;
+  uint64_t hashes[SIZEOF(_hdrtoken_strs)];
+  int order[SIZEOF(_hdrtoken_strs)];
+  int group_size[num_groups];
+
+  hdrtoken_hash_table_mask = size - 1;
+  for (uint32_t i = 0; i < size; ++i) {
+    hdrtoken_hash_table[i].wks    = nullptr;
+    hdrtoken_hash_table[i].length = -1;
+  }
+  memset(group_size, 0, sizeof(group_size));
 
-  // HTTP methods
-  "CONNECT", "DELETE", "GET", "POST", "HEAD", "OPTIONS", "PURGE", "PUT", "TRACE", "PUSH",
+  for (int i = 0; i < hdrtoken_num_wks; ++i) {
+    char folded[HDRTOKEN_MAX_LENGTH];
+    hashes[i] = hdrtoken_hash(hdrtoken_strs[i], hdrtoken_str_lengths[i], folded);
+    order[i]  = i;
+    ++group_size[hdrtoken_hash_to_displacement(hashes[i])];
+  }
 
-  // Header extensions
-  "X-ID", "X-Forwarded-For", "TE", "Strict-Transport-Security", "100-continue",
+  // Place the largest groups first while the table is emptiest
+  std::sort(order, order + hdrtoken_num_wks, [&](int a, int b) {
+    uint32_t ga = hdrtoken_hash_to_displacement(hashes[a]), gb = hdrtoken_hash_to_displacement(hashes[b]);
+    return group_size[ga] != group_size[gb] ? group_size[ga] > group_size[gb] : ga < gb;
+  });
+
+  for (int first = 0; first < hdrtoken_num_wks;) {
+    uint32_t group = hdrtoken_hash_to_displacement(hashes[order[first]]);
+    int last       = first + group_size[group];
+    uint32_t d;
+
+    for (d = 0; d < size; ++d) {
+      hdrtoken_hash_displacements[group] = d;
+      int i;
+      for (i = first; i < last; ++i) {
+        uint32_t slot = hdrtoken_hash_to_slot(hashes[order[i]]);
+        if (hdrtoken_hash_table[slot].wks) {
+          break;
+        }
+        hdrtoken_hash_table[slot].wks = hdrtoken_strs[order[i]];
+      }
+      if (i == last) {
+        break;
+      }
+      while (i-- > first) { // two strings of the group collided, take them out and try the next displacement
+        hdrtoken_hash_table[hdrtoken_hash_to_slot(hashes[order[i]])].wks = nullptr;
+      }
+    }
+    if (d == size) {
+      return false;
+    }
+    first = last;
+  }
 
-  // RFC-2739
-  "Forwarded"};
+  for (int i = 0; i < hdrtoken_num_wks; ++i) {
+    HdrTokenHashBucket *bucket = &hdrtoken_hash_table[hdrtoken_hash_to_slot(hashes[i])];
 
-/*-------------------------------------------------------------------------
-  -------------------------------------------------------------------------*/
+    memset(bucket->folded, 0, sizeof(bucket->folded));
+    hdrtoken_hash(hdrtoken_strs[i], hdrtoken_str_lengths[i], bucket->folded);
+    bucket->length = hdrtoken_str_lengths[i];
+  }
+  return true;
+}
 
 void
 hdrtoken_hash_init()
 {
-  uint32_t i;
-  int num_collisions;
-
-  memset(hdrtoken_hash_table, 0, sizeof(hdrtoken_hash_table));
-  num_collisions = 0;
-
-  for (i = 0; i < (int)SIZEOF(_hdrtoken_commonly_tokenized_strs); i++) {
-    // convert the common string to the well-known token
-    unsigned const char *wks;
-    int wks_idx = hdrtoken_tokenize_dfa(_hdrtoken_commonly_tokenized_strs[i], (int)strlen(_hdrtoken_commonly_tokenized_strs[i]),
-                                        (const char **)&wks);
-    ink_release_assert(wks_idx >= 0);
-
-    uint32_t hash = hdrtoken_hash(wks, hdrtoken_str_lengths[wks_idx]);
-    uint32_t slot = hash_to_slot(hash);
-
-    if (hdrtoken_hash_table[slot].wks) {
-      printf("ERROR: hdrtoken_hash_table[%u] collision: '%s' replacing '%s'\n", slot, (const char *)wks,
-             hdrtoken_hash_table[slot].wks);
-      ++num_collisions;
-    }
-    hdrtoken_hash_table[slot].wks  = (const char *)wks;
-    hdrtoken_hash_table[slot].hash = hash;
+  uint32_t size;
+
+  for (int i = 0; i < hdrtoken_num_wks; ++i) {
+    ink_release_assert(hdrtoken_str_lengths[i] <= HDRTOKEN_MAX_LENGTH);
   }
 
-  if (num_collisions > 0) {
-    abort();
+  // Start with the smallest power of two that holds every string, and grow until each group finds a displacement
+  for (size = 1; size < (uint32_t)hdrtoken_num_wks; size <<= 1) {
   }
+  while (!hdrtoken_hash_build(size)) {
+    size <<= 1;
+    if (size > HDRTOKEN_HASH_TABLE_MAX_SIZE) {
+      printf("ERROR: hdrtoken_hash_table has no perfect hash for %d strings, a string is listed twice?\n", hdrtoken_num_wks);
+      abort();
+    }
+  }
+  Debug("hdr_token", "perfect hash of %d well-known strings in %u slots", hdrtoken_num_wks, size);
 }
 
 /***********************************************************************
@@ -426,9 +442,6 @@ hdrtoken_init()
   if (!inited) {
     inited = 1;
 
-    hdrtoken_strs_dfa = new DFA;
-    hdrtoken_strs_dfa->compile(_hdrtoken_strs, SIZEOF(_hdrtoken_strs), (REFlags)(RE_CASE_INSENSITIVE));
-
     // all the tokenized hdrtoken strings are placed in a special heap,
     // and each string is prepended with a HdrTokenHeapPrefix ---
     // this makes it easy to tell that a string is a tokenized
@@ -473,13 +486,14 @@ hdrtoken_init()
       heap_size -= sstr_len;
     }
 
+    hdrtoken_hash_init();
+
     // Set the token types for certain tokens
     for (i = 0; _hdrtoken_strs_type_initializers[i].name != nullptr; i++) {
       int wks_idx;
       HdrTokenHeapPrefix *prefix;
 
-      wks_idx =
-        hdrtoken_tokenize_dfa(_hdrtoken_strs_type_initializers[i].name, (int)strlen(_hdrtoken_strs_type_initializers[i].name));
+      wks_idx = hdrtoken_tokenize(_hdrtoken_strs_type_initializers[i].name, (int)strlen(_hdrtoken_strs_type_initializers[i].name));
 
       ink_assert((wks_idx >= 0) && (wks_idx < (int)SIZEOF(hdrtoken_strs)));
       // coverity[negative_returns]
@@ -493,7 +507,7 @@ hdrtoken_init()
       HdrTokenHeapPrefix *prefix;
 
       wks_idx =
-        hdrtoken_tokenize_dfa(_hdrtoken_strs_field_initializers[i].name, (int)strlen(_hdrtoken_strs_field_initializers[i].name));
+        hdrtoken_tokenize(_hdrtoken_strs_field_initializers[i].name, (int)strlen(_hdrtoken_strs_field_initializers[i].name));
 
       ink_assert((wks_idx >= 0) && (wks_idx < (int)SIZEOF(hdrtoken_strs)));
       prefix                  = hdrtoken_index_to_prefix(wks_idx);
@@ -510,36 +524,9 @@ hdrtoken_init()
       hdrtoken_str_masks[i]       = prefix->wks_info.mask;   // parallel array for speed
       hdrtoken_str_flags[i]       = prefix->wks_info.flags;  // parallel array for speed
     }
-
-    hdrtoken_hash_init();
   }
 }
 
-/*-------------------------------------------------------------------------
-  -------------------------------------------------------------------------*/
-
-int
-hdrtoken_tokenize_dfa(const char *string, int string_len, const char **wks_string_out)
-{
-  int wks_idx;
-
-  wks_idx = hdrtoken_strs_dfa->match(string, string_len);
-
-  if (wks_idx < 0) {
-    wks_idx = -1;
-  }
-  if (wks_string_out) {
-    if (wks_idx >= 0) {
-      *wks_string_out = hdrtoken_index_to_wks(wks_idx);
-    } else {
-      *wks_string_out = nullptr;
-    }
-  }
-  // printf("hdrtoken_tokenize_dfa(%d,*s) - return %d\n",string_len,string,wks_idx);
-
-  return wks_idx;
-}
-
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -559,16 +546,18 @@ hdrtoken_tokenize(const char *string, int string_len, const char **wks_string_ou
     return wks_idx;
   }
 
-  uint32_t hash = hdrtoken_hash((const unsigned char *)string, (unsigned int)string_len);
-  uint32_t slot = hash_to_slot(hash);
-
-  bucket = &(hdrtoken_hash_table[slot]);
-  if ((bucket->wks != nullptr) && (bucket->hash == hash) && (hdrtoken_wks_to_length(bucket->wks) == string_len)) {
-    wks_idx = hdrtoken_wks_to_index(bucket->wks);
-    if (wks_string_out) {
-      *wks_string_out = bucket->wks;
+  if (string_len <= HDRTOKEN_MAX_LENGTH) {
+    char folded[HDRTOKEN_MAX_LENGTH] __attribute__((aligned(16))) = {0};
+    uint64_t hash                                                 = hdrtoken_hash(string, string_len, folded);
+
+    bucket = &hdrtoken_hash_table[hdrtoken_hash_to_slot(hash)];
+    if (bucket->length == string_len && hdrtoken_folded_eq(bucket->folded, folded)) {
+      wks_idx = hdrtoken_wks_to_index(bucket->wks);
+      if (wks_string_out) {
+        *wks_string_out = bucket->wks;
+      }
+      return wks_idx;
     }
-    return wks_idx;
   }
 
   Debug("hdr_token", "Did not find a WKS for '%.*s'", string_len, string);
@@ -31,7 +31,6 @@
 #include "ts/ink_defs.h"
 #include "ts/ink_string.h"
 #include "ts/Allocator.h"
-#include "ts/Regex.h"
 #include "ts/ink_apidefs.h"
 
 ////////////////////////////////////////////////////////////////////////////
@@ -92,7 +91,6 @@ enum HdrTokenInfoFlags {
 #define MIME_FLAGS_HOPBYHOP HTIF_HOPBYHOP
 #define MIME_FLAGS_PROXYAUTH HTIF_PROXYAUTH
 
-extern DFA *hdrtoken_strs_dfa;
 extern int hdrtoken_num_wks;
 
 extern const char *hdrtoken_strs[];
@@ -109,7 +107,6 @@ extern uint32_t hdrtoken_str_flags[];
 ////////////////////////////////////////////////////////////////////////////
 
 extern void hdrtoken_init();
-extern int hdrtoken_tokenize_dfa(const char *string, int string_len, const char **wks_string_out = NULL);
 inkcoreapi extern int hdrtoken_tokenize(const char *string, int string_len, const char **wks_string_out = NULL);
 extern const char *hdrtoken_string_to_wks(const char *string);
 extern const char *hdrtoken_string_to_wks(const char *string, int length);
@@ -538,6 +538,175 @@ mime_hdr_reset_accelerators_and_presence_bits(MIMEHdrImpl *mh)
   }
 }
 
+/*-------------------------------------------------------------------------
+  Looking up a name without a slot accelerator walks every slot of the
+  header.  Once a header spans MIME_FIELD_INDEX_MIN_BLOCKS field blocks,
+  the first such lookup builds an index from name hash to the slot of each
+  dup list head, kept in a small per thread cache.  m_field_index_id names
+  the index that describes the header; attaching a new head updates the
+  index of the attaching thread under a fresh id, any other change clears
+  the id, so an index that went stale is never consulted.
+  -------------------------------------------------------------------------*/
+
+#define MIME_FIELD_INDEX_MIN_BLOCKS 3 // more than 32 slots
+#define MIME_FIELD_INDEX_SLOTS 512    // power of two, indexes at most half of it
+#define MIME_FIELD_INDEX_CACHED 4     // indexes each thread keeps
+
+struct MIMEFieldIndex {
+  const MIMEHdrImpl *mh;
+  uint32_t id;
+  uint32_t num_names;
+  uint32_t hashes[MIME_FIELD_INDEX_SLOTS]; // 0 for an empty slot
+  uint32_t slotnums[MIME_FIELD_INDEX_SLOTS];
+};
+
+static thread_local MIMEFieldIndex mime_field_indexes[MIME_FIELD_INDEX_CACHED];
+static thread_local unsigned int mime_field_index_victim;
+static uint32_t mime_field_index_last_id;
+
+static inline uint32_t
+mime_field_index_hash(const char *name, int length)
+{
+  uint32_t hash = 2166136261U;
+
+  for (int i = 0; i < length; ++i) {
+    hash = (hash ^ static_cast<unsigned char>(ParseRules::ink_tolower(name[i]))) * 16777619U;
+  }
+  return hash | 1;
+}
+
+static inline uint32_t
+mime_field_index_new_id()
+{
+  uint32_t id;
+
+  do {
+    id = ink_atomic_increment(&mime_field_index_last_id, 1U) + 1;
+  } while (id == 0);
+  return id;
+}
+
+static inline void
+mime_hdr_field_index_invalidate(MIMEHdrImpl *mh)
+{
+  mh->m_field_index_id = 0;
+}
+
+// Returns this thread's index of @a mh if it is current
+static inline MIMEFieldIndex *
+mime_hdr_field_index_find(const MIMEHdrImpl *mh)
+{
+  if (mh->m_field_index_id != 0) {
+    for (auto &index : mime_field_indexes) {
+      if (index.mh == mh && index.id == mh->m_field_index_id) {
+        return &index;
+      }
+    }
+  }
+  return nullptr;
+}
+
+// Adds @a field at @a slotnum unless a field of that name is already indexed, false if the index is full
+static bool
+mime_field_index_insert(MIMEFieldIndex *index, MIMEHdrImpl *mh, MIMEField *field, uint32_t slotnum)
+{
+  uint32_t hash = mime_field_index_hash(field->m_ptr_name, field->m_len_name);
+  uint32_t i    = hash & (MIME_FIELD_INDEX_SLOTS - 1);
+
+  for (; index->hashes[i] != 0; i = (i + 1) & (MIME_FIELD_INDEX_SLOTS - 1)) {
+    if (index->hashes[i] == hash) {
+      MIMEField *other = _mime_hdr_field_list_search_by_slotnum(mh, index->slotnums[i]);
+      if (other->m_len_name == field->m_len_name && strncasecmp(other->m_ptr_name, field->m_ptr_name, field->m_len_name) == 0) {
+        return true;
+      }
+    }
+  }
+  if (index->num_names >= MIME_FIELD_INDEX_SLOTS / 2) {
+    return false;
+  }
+  ++index->num_names;
+  index->hashes[i]   = hash;
+  index->slotnums[i] = slotnum;
+  return true;
+}
+
+// Returns the index of @a mh, building it if the header is large enough to need one
+static MIMEFieldIndex *
+mime_hdr_field_index_get(MIMEHdrImpl *mh)
+{
+  MIMEFieldBlockImpl *fblock;
+  int num_blocks = 1;
+
+  for (fblock = mh->m_first_fblock.m_next; fblock && num_blocks < MIME_FIELD_INDEX_MIN_BLOCKS; fblock = fblock->m_next) {
+    ++num_blocks;
+  }
+  if (num_blocks < MIME_FIELD_INDEX_MIN_BLOCKS) {
+    return nullptr;
+  }
+
+  MIMEFieldIndex *index = mime_hdr_field_index_find(mh);
+  if (index) {
+    return index;
+  }
+
+  index = &mime_field_indexes[mime_field_index_victim++ % MIME_FIELD_INDEX_CACHED];
+  memset(index->hashes, 0, sizeof(index->hashes));
+  index->mh        = nullptr;
+  index->num_names = 0;
+
+  uint32_t slotnum = 0;
+  for (fblock = &(mh->m_first_fblock); fblock != nullptr; fblock = fblock->m_next) {
+    for (uint32_t i = 0; i < fblock->m_freetop; ++i, ++slotnum) {
+      MIMEField *field = &(fblock->m_field_slots[i]);
+      if (field->is_live() && field->is_dup_head() && !mime_field_index_insert(index, mh, field, slotnum)) {
+        return nullptr; // too many names, keep walking the list
+      }
+    }
+    slotnum += MIME_FIELD_BLOCK_SLOTS - fblock->m_freetop;
+  }
+
+  // A header that is only read, e.g. one shared from the cache, keeps its id so other threads can index it too
+  if (mh->m_field_index_id == 0) {
+    mh->m_field_index_id = mime_field_index_new_id();
+  }
+  index->mh = mh;
+  index->id = mh->m_field_index_id;
+  return index;
+}
+
+// Records that @a field became the head of a new dup list
+static void
+mime_hdr_field_index_add(MIMEHdrImpl *mh, MIMEField *field)
+{
+  MIMEFieldIndex *index = mime_hdr_field_index_find(mh);
+
+  if (index && mime_field_index_insert(index, mh, field, mime_hdr_field_slotnum(mh, field))) {
+    index->id = mh->m_field_index_id = mime_field_index_new_id();
+  } else {
+    if (index) {
+      index->mh = nullptr;
+    }
+    mime_hdr_field_index_invalidate(mh);
+  }
+}
+
+static MIMEField *
+_mime_hdr_field_list_search_by_index(MIMEFieldIndex *index, MIMEHdrImpl *mh, const char *field_name_str, int field_name_len)
+{
+  uint32_t hash = mime_field_index_hash(field_name_str, field_name_len);
+
+  for (uint32_t i = hash & (MIME_FIELD_INDEX_SLOTS - 1); index->hashes[i] != 0; i = (i + 1) & (MIME_FIELD_INDEX_SLOTS - 1)) {
+    if (index->hashes[i] == hash) {
+      MIMEField *field = _mime_hdr_field_list_search_by_slotnum(mh, index->slotnums[i]);
+      if (field && field->is_live() && field->m_len_name == field_name_len &&
+          strncasecmp(field->m_ptr_name, field_name_str, field_name_len) == 0) {
+        return field;
+      }
+    }
+  }
+  return nullptr;
+}
+
 int
 checksum_block(const char *s, int len)
 {
@@ -1043,6 +1212,7 @@ void
 mime_hdr_init(MIMEHdrImpl *mh)
 {
   mime_hdr_init_accelerators_and_presence_bits(mh);
+  mime_hdr_field_index_invalidate(mh);
 
   mime_hdr_cooked_stuff_init(mh, nullptr);
 
@@ -1101,13 +1271,11 @@ mime_hdr_copy_onto(MIMEHdrImpl *s_mh, HdrHeap *s_heap, MIMEHdrImpl *d_mh, HdrHea
   int block_count;
   MIMEFieldBlockImpl *s_fblock, *d_fblock, *prev_d_fblock;
 
-  // If there are chained field blocks beyond the first one, we're just going to
-  //   destroy them.  Ideally, we'd use them if the copied in header needed
-  //   extra blocks.  It's too late in the Tomcat code cycle to implement
-  //   reuse.
-  if (d_mh->m_first_fblock.m_next) {
-    mime_hdr_destroy_field_block_list(d_heap, d_mh->m_first_fblock.m_next);
-  }
+  // Chained field blocks beyond the first one are reused for the blocks
+  //   of the copied in header, any left over are destroyed.  A header
+  //   that is copied onto repeatedly, as on retries, then stops growing
+  //   its heap with dead blocks.
+  MIMEFieldBlockImpl *spare_fblocks = d_mh->m_first_fblock.m_next;
 
   ink_assert(((char *)&(s_mh->m_first_fblock.m_field_slots[MIME_FIELD_BLOCK_SLOTS]) - (char *)s_mh) == sizeof(struct MIMEHdrImpl));
 
@@ -1117,6 +1285,8 @@ mime_hdr_copy_onto(MIMEHdrImpl *s_mh, HdrHeap *s_heap, MIMEHdrImpl *d_mh, HdrHea
 
   // copies useful part of enclosed first block too
   memcpy(d_mh, s_mh, bytes_below_top);
+  mime_hdr_field_index_invalidate(d_mh);
+  hdr_heap_counters.bytes_copied += bytes_below_top;
 
   if (d_mh->m_first_fblock.m_next == nullptr) // common case: no other block
   {
@@ -1128,12 +1298,20 @@ mime_hdr_copy_onto(MIMEHdrImpl *s_mh, HdrHeap *s_heap, MIMEHdrImpl *d_mh, HdrHea
     block_count   = 1;
     for (s_fblock = s_mh->m_first_fblock.m_next; s_fblock != nullptr; s_fblock = s_fblock->m_next) {
       ++block_count;
-      d_fblock              = _mime_field_block_copy(s_fblock, s_heap, d_heap);
+      if (spare_fblocks) {
+        d_fblock      = spare_fblocks;
+        spare_fblocks = spare_fblocks->m_next;
+        memcpy(d_fblock, s_fblock, sizeof(MIMEFieldBlockImpl));
+      } else {
+        d_fblock = _mime_field_block_copy(s_fblock, s_heap, d_heap);
+      }
       prev_d_fblock->m_next = d_fblock;
       prev_d_fblock         = d_fblock;
     }
     d_mh->m_fblock_list_tail = prev_d_fblock;
+    hdr_heap_counters.bytes_copied += (block_count - 1) * sizeof(MIMEFieldBlockImpl);
   }
+  mime_hdr_destroy_field_block_list(d_heap, spare_fblocks);
 
   if (inherit_strs) {
     d_heap->inherit_string_heaps(s_heap);
@@ -1347,7 +1525,9 @@ mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_
     // search by well-known string index or by case-insensitive string match //
     ///////////////////////////////////////////////////////////////////////////
 
-    MIMEField *f = _mime_hdr_field_list_search_by_wks(mh, token_info->wks_idx);
+    MIMEFieldIndex *index = mime_hdr_field_index_get(mh);
+    MIMEField *f          = index ? _mime_hdr_field_list_search_by_index(index, mh, field_name_str, field_name_len) :
+                               _mime_hdr_field_list_search_by_wks(mh, token_info->wks_idx);
     ink_assert((f == nullptr) || f->is_live());
 #if TRACK_FIELD_FIND_CALLS
     Debug("http", "mime_hdr_field_find(hdr 0x%X, field %.*s): %s (due to WKS list walk)", mh, field_name_len, field_name_str,
@@ -1355,7 +1535,9 @@ mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_
 #endif
     return f;
   } else {
-    MIMEField *f = _mime_hdr_field_list_search_by_string(mh, field_name_str, field_name_len);
+    MIMEFieldIndex *index = mime_hdr_field_index_get(mh);
+    MIMEField *f          = index ? _mime_hdr_field_list_search_by_index(index, mh, field_name_str, field_name_len) :
+                               _mime_hdr_field_list_search_by_string(mh, field_name_str, field_name_len);
 
     ink_assert((f == nullptr) || f->is_live());
 #if TRACK_FIELD_FIND_CALLS
@@ -1539,6 +1721,7 @@ mime_hdr_field_attach(MIMEHdrImpl *mh, MIMEField *field, int check_for_dups, MIM
       field->m_next_dup = prev_dup;
       prev_dup->m_flags = (prev_dup->m_flags & ~MIME_FIELD_SLOT_FLAGS_DUP_HEAD);
       mime_hdr_set_accelerators_and_presence_bits(mh, field);
+      mime_hdr_field_index_invalidate(mh);
     } else // patch us after prev, and before next
     {
       ink_assert(prev_slotnum < field_slotnum);
@@ -1551,6 +1734,7 @@ mime_hdr_field_attach(MIMEHdrImpl *mh, MIMEField *field, int check_for_dups, MIM
   } else {
     field->m_flags = (field->m_flags | MIME_FIELD_SLOT_FLAGS_DUP_HEAD);
     mime_hdr_set_accelerators_and_presence_bits(mh, field);
+    mime_hdr_field_index_add(mh, field);
   }
 
   // Now keep the cooked cache consistent
@@ -1585,6 +1769,7 @@ mime_hdr_field_detach(MIMEHdrImpl *mh, MIMEField *field, bool detach_all_dups)
 
   if (field->m_flags & MIME_FIELD_SLOT_FLAGS_DUP_HEAD) // head of list?
   {
+    mime_hdr_field_index_invalidate(mh);
     if (!next_dup) // only child
     {
       mime_hdr_unset_accelerators_and_presence_bits(mh, field);
@@ -3754,6 +3939,7 @@ MIMEHdrImpl::marshal(MarshalXlate *ptr_xlate, int num_ptr, MarshalXlate *str_xla
 void
 MIMEHdrImpl::unmarshal(intptr_t offset)
 {
+  mime_hdr_field_index_invalidate(this);
   HDR_UNMARSHAL_PTR(m_fblock_list_tail, MIMEFieldBlockImpl, offset);
   m_first_fblock.unmarshal(offset);
 }
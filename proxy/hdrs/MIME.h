@@ -247,7 +247,8 @@ struct MIMECooked {
  ***********************************************************************/
 
 struct MIMEHdrImpl : public HdrHeapObjImpl {
-  // HdrHeapObjImpl is 4 bytes, so this will result in 4 bytes padding
+  // HdrHeapObjImpl is 4 bytes, the id of the field name index fills the padding before m_presence_bits
+  uint32_t m_field_index_id;
   uint64_t m_presence_bits;
   uint32_t m_slot_accelerators[4];
 
@@ -268,6 +268,7 @@ url_copy_onto(URLImpl *s_url, HdrHeap *s_heap, URLImpl *d_url, HdrHeap *d_heap,
 {
   if (s_url != d_url) {
     obj_copy_data((HdrHeapObjImpl *)s_url, (HdrHeapObjImpl *)d_url);
+    hdr_heap_counters.bytes_copied += d_url->m_length;
     if (inherit_strs && (s_heap != d_heap)) {
       d_heap->inherit_string_heaps(s_heap);
     }
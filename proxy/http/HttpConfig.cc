@@ -368,6 +368,15 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.user_agent_response_header_total_size", RECD_INT, RECP_PERSISTENT,
                      (int)http_user_agent_response_header_total_size_stat, RecRawStatSyncSum);
 
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.avg_header_heap_bytes_allocated_per_transaction", RECD_FLOAT,
+                     RECP_PERSISTENT, (int)http_header_heap_bytes_allocated_stat, RecRawStatSyncAvg);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.avg_header_heap_bytes_copied_per_transaction", RECD_FLOAT,
+                     RECP_PERSISTENT, (int)http_header_heap_bytes_copied_stat, RecRawStatSyncAvg);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.avg_state_machine_bytes_per_transaction", RECD_FLOAT,
+                     RECP_PERSISTENT, (int)http_sm_memory_bytes_stat, RecRawStatSyncAvg);
+
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.user_agent_request_document_total_size", RECD_INT, RECP_PERSISTENT,
                      (int)http_user_agent_request_document_total_size_stat, RecRawStatSyncSum);
 
@@ -1091,6 +1100,7 @@ HttpConfig::startup()
   HttpEstablishStaticConfigByte(c.parser_allow_non_http, "proxy.config.http.parse.allow_non_http");
 
   HttpEstablishStaticConfigByte(c.keepalive_internal_vc, "proxy.config.http.keepalive_internal_vc");
+  HttpEstablishStaticConfigByte(c.splice_tunnel, "proxy.config.http.splice_tunnel");
 
   HttpEstablishStaticConfigByte(c.oride.cache_open_write_fail_action, "proxy.config.http.cache.open_write_fail_action");
 
@@ -1368,6 +1378,7 @@ HttpConfig::reconfigure()
   params->disallow_post_100_continue = INT_TO_BOOL(m_master.disallow_post_100_continue);
   params->parser_allow_non_http      = INT_TO_BOOL(m_master.parser_allow_non_http);
   params->keepalive_internal_vc      = INT_TO_BOOL(m_master.keepalive_internal_vc);
+  params->splice_tunnel              = INT_TO_BOOL(m_master.splice_tunnel);
 
   params->oride.cache_open_write_fail_action = m_master.oride.cache_open_write_fail_action;
 
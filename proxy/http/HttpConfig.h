@@ -121,6 +121,9 @@ enum {
   // document size stats
   http_user_agent_request_header_total_size_stat,
   http_user_agent_response_header_total_size_stat,
+  http_header_heap_bytes_allocated_stat,
+  http_header_heap_bytes_copied_stat,
+  http_sm_memory_bytes_stat,
   http_user_agent_request_document_total_size_stat,
   http_user_agent_response_document_total_size_stat,
 
@@ -845,6 +848,7 @@ public:
   MgmtByte disallow_post_100_continue = 0;
   MgmtByte parser_allow_non_http      = 1;
   MgmtByte keepalive_internal_vc      = 0;
+  MgmtByte splice_tunnel              = 0;
 
   MgmtByte server_session_sharing_pool = TS_SERVER_SESSION_SHARING_POOL_THREAD;
 
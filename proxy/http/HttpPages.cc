@@ -218,7 +218,7 @@ HttpPagesHandler::dump_history(HttpSM *sm)
     resp_begin_row();
 
     resp_begin_column();
-    resp_add("%s", sm->history[i].location.str(buf, sizeof(buf)));
+    resp_add("%s", sm->history[i].location().str(buf, sizeof(buf)));
     resp_end_column();
 
     resp_begin_column();
@@ -125,11 +125,22 @@ make_net_accept_options(const HttpProxyPort *port, unsigned nthreads)
   REC_ReadConfigInteger(net.tfo_queue_length, "proxy.config.net.sock_option_tfo_queue_size_in");
 #endif
 
+  REC_ReadConfigInteger(net.client_max_connections, "proxy.config.net.per_client.max_connections_in");
+  REC_ReadConfigInteger(net.client_connection_rate, "proxy.config.net.per_client.connection_rate_in");
+  REC_ReadConfigInteger(net.client_connection_burst, "proxy.config.net.per_client.connection_burst_in");
+
   if (port) {
     net.f_inbound_transparent = port->m_inbound_transparent_p;
     net.ip_family             = port->m_family;
     net.local_port            = port->m_port;
 
+    if (port->m_client_max_connections >= 0) {
+      net.client_max_connections = port->m_client_max_connections;
+    }
+    if (port->m_client_connection_rate >= 0) {
+      net.client_connection_rate = port->m_client_connection_rate;
+    }
+
     if (port->m_inbound_ip.isValid()) {
       net.local_ip = port->m_inbound_ip;
     } else if (AF_INET6 == port->m_family && HttpConfig::m_master.inbound_ip6.isIp6()) {
@@ -457,7 +457,10 @@ HttpSM::attach_client_session(ProxyClientTransaction *client_vc, IOBufferReader
   client_protocol          = protocol_str ? protocol_str : "-";
 
   ink_release_assert(ua_session->get_half_close_flag() == false);
-  mutex = client_vc->mutex;
+  // The transaction may come with a mutex of its own to run apart from its session, see Http2Stream::start_transaction
+  if (!mutex) {
+    mutex = client_vc->mutex;
+  }
   HTTP_INCREMENT_DYN_STAT(http_current_client_transactions_stat);
   if (ua_session->debug()) {
     debug_on = true;
@@ -1616,6 +1619,9 @@ HttpSM::handle_api_return()
       HttpTunnelProducer *p = setup_server_transfer();
       perform_cache_write_action();
       tunnel.tunnel_run(p);
+      if (server_session && ua_session) {
+        splice_tunnel_producer(p, server_session->get_netvc(), splice_client_netvc());
+      }
     }
     break;
   }
@@ -2036,7 +2042,6 @@ HttpSM::process_srv_info(HostDBInfo *r)
 
   /* we didn't get any SRV records, continue w normal lookup */
   if (!r || !r->is_srv || !r->round_robin) {
-    t_state.dns_info.srv_hostname[0]    = '\0';
     t_state.dns_info.srv_lookup_success = false;
     t_state.txn_conf->srv_enabled       = false;
     DebugSM("dns_srv", "No SRV records were available, continuing to lookup %s", t_state.dns_info.lookup_name);
@@ -2044,12 +2049,15 @@ HttpSM::process_srv_info(HostDBInfo *r)
     HostDBRoundRobin *rr = r->rr();
     HostDBInfo *srv      = nullptr;
     if (rr) {
+      if (t_state.dns_info.srv_hostname == nullptr) {
+        t_state.dns_info.srv_hostname = static_cast<char *>(t_state.arena.alloc(MAXDNAME, 1));
+      }
+      t_state.dns_info.srv_hostname[0] = '\0';
       srv = rr->select_best_srv(t_state.dns_info.srv_hostname, &mutex->thread_holding->generator, ink_local_time(),
                                 (int)t_state.txn_conf->down_server_timeout);
     }
     if (!srv) {
       t_state.dns_info.srv_lookup_success = false;
-      t_state.dns_info.srv_hostname[0]    = '\0';
       t_state.txn_conf->srv_enabled       = false;
       DebugSM("dns_srv", "SRV records empty for %s", t_state.dns_info.lookup_name);
     } else {
@@ -2518,6 +2526,10 @@ HttpSM::main_handler(int event, void *data)
 
   HttpVCTableEntry *vc_entry = nullptr;
 
+  // Charge the header heap traffic of this event to the transaction,
+  //  nested calls are covered by the outermost one
+  const HdrHeapCounters hdr_heap_start = hdr_heap_counters;
+
   if (data != nullptr) {
     // Only search the VC table if the event could have to
     //  do with a VIO to save a few cycles
@@ -2537,6 +2549,11 @@ HttpSM::main_handler(int event, void *data)
     (this->*default_handler)(event, data);
   }
 
+  if (reentrancy_count == 1) {
+    hdr_heap_bytes_allocated += hdr_heap_counters.bytes_allocated - hdr_heap_start.bytes_allocated;
+    hdr_heap_bytes_copied += hdr_heap_counters.bytes_copied - hdr_heap_start.bytes_copied;
+  }
+
   // The sub-handler signals when it is time for the state
   //  machine to exit.  We can only exit if we are not reentrantly
   //  called otherwise when the our call unwinds, we will be
@@ -3215,19 +3232,21 @@ HttpSM::tunnel_handler_ua(int event, HttpTunnelConsumer *c)
   ink_assert(ua_entry->vc == c->vc);
   if (close_connection) {
     // If the client could be pipelining or is doing a POST, we need to
-    //   set the ua_session into half close mode
-
-    // only external POSTs should be subject to this logic; ruling out internal POSTs here
-    bool is_eligible_post_request = (t_state.method == HTTP_WKSIDX_POST);
-    if (is_eligible_post_request) {
-      NetVConnection *vc = ua_session->get_netvc();
-      if (vc) {
-        is_eligible_post_request &= !vc->get_is_internal_request();
+    //   set the ua_session into half close mode. Transactions that share
+    //   their connection, such as HTTP/2 streams, are never half open.
+    if (ua_session->allow_half_open()) {
+      // only external POSTs should be subject to this logic; ruling out internal POSTs here
+      bool is_eligible_post_request = (t_state.method == HTTP_WKSIDX_POST);
+      if (is_eligible_post_request) {
+        NetVConnection *vc = ua_session->get_netvc();
+        if (vc) {
+          is_eligible_post_request &= !vc->get_is_internal_request();
+        }
+      }
+      if ((is_eligible_post_request || t_state.client_info.pipeline_possible == true) && c->producer->vc_type != HT_STATIC &&
+          event == VC_EVENT_WRITE_COMPLETE) {
+        ua_session->set_half_close_flag(true);
       }
-    }
-    if ((is_eligible_post_request || t_state.client_info.pipeline_possible == true) && c->producer->vc_type != HT_STATIC &&
-        event == VC_EVENT_WRITE_COMPLETE) {
-      ua_session->set_half_close_flag(true);
     }
 
     ua_session->do_io_close();
@@ -5796,8 +5815,9 @@ HttpSM::attach_server_session(HttpServerSession *s)
   UnixNetVConnection *client_vc = (UnixNetVConnection *)(ua_session->get_netvc());
   SSLNetVConnection *ssl_vc     = dynamic_cast<SSLNetVConnection *>(client_vc);
 
-  // Verifying that the user agent and server sessions/transactions are operating on the same thread.
-  ink_release_assert(!server_vc || !client_vc || server_vc->thread == client_vc->thread);
+  // Verifying that the user agent and server sessions/transactions are operating on the same thread, or on the thread of a
+  // transaction that runs apart from its client session.
+  ink_release_assert(!server_vc || !client_vc || server_vc->thread == client_vc->thread || server_vc->thread == this_ethread());
   bool associated_connection = false;
   if (server_vc) { // if server_vc isn't a PluginVC
     if (ssl_vc) {  // if incoming connection is SSL
@@ -6629,6 +6649,12 @@ HttpSM::setup_blind_tunnel(bool send_response_hdr, IOBufferReader *initial)
 
   tunnel.tunnel_run();
 
+  // CONNECT tunnels to a raw server connection rather than a session.
+  NetVConnection *server_netvc = server_session ? server_session->get_netvc() : dynamic_cast<NetVConnection *>(server_entry->vc);
+  NetVConnection *client_netvc = splice_client_netvc();
+  splice_tunnel_producer(p_os, server_netvc, client_netvc);
+  splice_tunnel_producer(p_ua, client_netvc, server_netvc);
+
   // If we're half closed, we got a FIN from the client. Forward it on to the origin server
   // now that we have the tunnel operational.
   if (ua_session->get_half_close_flag()) {
@@ -6636,6 +6662,39 @@ HttpSM::setup_blind_tunnel(bool send_response_hdr, IOBufferReader *initial)
   }
 }
 
+// Have the kernel move the bytes from @a p straight to its consumer if
+// nothing in between needs to see them.
+void
+HttpSM::splice_tunnel_producer(HttpTunnelProducer *p, NetVConnection *src, NetVConnection *dst)
+{
+  HttpTunnelConsumer *c = p->consumer_list.head;
+
+  if (!t_state.http_config_param->splice_tunnel || !p->alive || !src || !dst) {
+    return;
+  }
+  // A single consumer taking the bytes as they are. POST bodies are kept for
+  // redirects.
+  if (c == nullptr || c->link.next != nullptr || p->do_chunking || p->do_dechunking || p->do_chunked_passthru ||
+      (p->vc_type == HT_HTTP_CLIENT && enable_redirection)) {
+    return;
+  }
+
+  if (src->splice_to(dst)) {
+    DebugSM("http_tunnel", "[%" PRId64 "] splicing %s to %s", sm_id, p->name, c->name);
+  }
+}
+
+// The client connection, if the bytes may be spliced to or from it. HTTP/2
+// streams share theirs, and it may belong to another thread than the SM's.
+NetVConnection *
+HttpSM::splice_client_netvc()
+{
+  if (!ua_session || client_protocol_contains(IP_PROTO_TAG_HTTP_2_0)) {
+    return nullptr;
+  }
+  return ua_session->get_netvc();
+}
+
 void
 HttpSM::setup_plugin_agents(HttpTunnelProducer *p)
 {
@@ -6833,6 +6892,17 @@ HttpSM::kill_this()
   }
 }
 
+int64_t
+HttpSM::memory_footprint() const
+{
+  int64_t bytes = sizeof(HttpSM) + t_state.arena.allocated_size();
+
+  if (second_cache_sm) {
+    bytes += sizeof(HttpCacheSM);
+  }
+  return bytes;
+}
+
 void
 HttpSM::update_stats()
 {
@@ -6892,6 +6962,10 @@ HttpSM::update_stats()
     os_read_time = -1;
   }
 
+  HTTP_SUM_DYN_STAT(http_header_heap_bytes_allocated_stat, hdr_heap_bytes_allocated);
+  HTTP_SUM_DYN_STAT(http_header_heap_bytes_copied_stat, hdr_heap_bytes_copied);
+  HTTP_SUM_DYN_STAT(http_sm_memory_bytes_stat, memory_footprint());
+
   HttpTransact::update_size_and_time_stats(
     &t_state, total_time, ua_write_time, os_read_time, client_request_hdr_bytes, client_request_body_bytes,
     client_response_hdr_bytes, client_response_body_bytes, server_request_hdr_bytes, server_request_body_bytes,
@@ -7011,7 +7085,7 @@ HttpSM::dump_state_on_assert()
     char buf[256];
     int r = history[i].reentrancy;
     int e = history[i].event;
-    Error("%d   %d   %s", e, r, history[i].location.str(buf, sizeof(buf)));
+    Error("%d   %d   %s", e, r, history[i].location().str(buf, sizeof(buf)));
   }
 
   // Dump the via string
@@ -251,6 +251,10 @@ public:
   int state_api_callback(int event, void *data);
   int state_api_callout(int event, void *data);
 
+  // Bytes held by this transaction: the state machine itself plus what it
+  //  allocated on demand (arena blocks, a second cache SM)
+  int64_t memory_footprint() const;
+
   // Used for Http Stat Pages
   HttpTunnel *
   get_tunnel()
@@ -467,6 +471,8 @@ protected:
   void perform_transform_cache_write_action();
   void perform_nca_cache_action();
   void setup_blind_tunnel(bool send_response_hdr, IOBufferReader *initial = nullptr);
+  void splice_tunnel_producer(HttpTunnelProducer *p, NetVConnection *src, NetVConnection *dst);
+  NetVConnection *splice_client_netvc();
   HttpTunnelProducer *setup_server_transfer_to_transform();
   HttpTunnelProducer *setup_transfer_from_transform();
   HttpTunnelProducer *setup_cache_transfer_to_transform();
@@ -499,6 +505,8 @@ public:
   int64_t cache_response_body_bytes  = 0;
   int pushed_response_hdr_bytes      = 0;
   int64_t pushed_response_body_bytes = 0;
+  int64_t hdr_heap_bytes_allocated   = 0;
+  int64_t hdr_heap_bytes_copied      = 0;
   bool client_tcp_reused             = false;
   // Info about client's SSL connection.
   bool client_ssl_reused          = false;
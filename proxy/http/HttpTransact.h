@@ -679,12 +679,12 @@ public:
 
     OS_Addr os_addr_style = OS_Addr::OS_ADDR_TRY_DEFAULT;
 
-    bool lookup_success         = false;
-    char *lookup_name           = nullptr;
-    char srv_hostname[MAXDNAME] = {0};
-    LookingUp_t looking_up      = UNDEFINED_LOOKUP;
-    bool srv_lookup_success     = false;
-    short srv_port              = 0;
+    bool lookup_success     = false;
+    char *lookup_name       = nullptr;
+    char *srv_hostname      = nullptr; ///< MAXDNAME bytes from State::arena, allocated by the first SRV lookup.
+    LookingUp_t looking_up  = UNDEFINED_LOOKUP;
+    bool srv_lookup_success = false;
+    short srv_port          = 0;
     HostDBApplicationInfo srv_app;
     /*** Set to true by default.  If use_client_target_address is set
      * to 1, this value will be set to false if the client address is
@@ -878,8 +878,8 @@ public:
     int64_t range_output_cl  = 0;
     RangeRecord *ranges      = nullptr;
 
-    OverridableHttpConfigParams *txn_conf = nullptr;
-    OverridableHttpConfigParams my_txn_conf; // Storage for plugins, to avoid malloc
+    OverridableHttpConfigParams *txn_conf    = nullptr;
+    OverridableHttpConfigParams *my_txn_conf = nullptr; // Storage for plugins, allocated from the arena on first override
 
     bool transparent_passthrough = false;
     bool range_in_cache          = false;
@@ -967,10 +967,14 @@ public:
     void
     setup_per_txn_configs()
     {
-      if (txn_conf != &my_txn_conf) {
+      if (txn_conf != my_txn_conf) {
+        // Most transactions never override anything, only those that do pay for the copy.
+        if (my_txn_conf == nullptr) {
+          my_txn_conf = static_cast<OverridableHttpConfigParams *>(arena.alloc(sizeof(OverridableHttpConfigParams)));
+        }
         // Make sure we copy it first.
-        memcpy(&my_txn_conf, &http_config_param->oride, sizeof(my_txn_conf));
-        txn_conf = &my_txn_conf;
+        memcpy(my_txn_conf, &http_config_param->oride, sizeof(OverridableHttpConfigParams));
+        txn_conf = my_txn_conf;
       }
     }
 
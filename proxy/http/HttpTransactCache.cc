@@ -150,6 +150,60 @@ is_empty(char *s)
   return (s[0] == NUL);
 }
 
+AltQualityMemo::AltQualityMemo(HTTPHdr *client_request)
+{
+  m_client_fields[ACCEPT]          = client_request->field_find(MIME_FIELD_ACCEPT, MIME_LEN_ACCEPT);
+  m_client_fields[ACCEPT_CHARSET]  = client_request->field_find(MIME_FIELD_ACCEPT_CHARSET, MIME_LEN_ACCEPT_CHARSET);
+  m_client_fields[ACCEPT_ENCODING] = client_request->field_find(MIME_FIELD_ACCEPT_ENCODING, MIME_LEN_ACCEPT_ENCODING);
+  m_client_fields[ACCEPT_LANGUAGE] = client_request->field_find(MIME_FIELD_ACCEPT_LANGUAGE, MIME_LEN_ACCEPT_LANGUAGE);
+}
+
+inline static const char *
+memo_key_value(MIMEField *field, int *len)
+{
+  if (field == nullptr) {
+    *len = -1;
+    return nullptr;
+  }
+  return field->value_get(len);
+}
+
+inline static bool
+memo_key_equal(const char *a, int a_len, const char *b, int b_len)
+{
+  return (a_len == b_len) && (a_len <= 0 || memcmp(a, b, a_len) == 0);
+}
+
+bool
+AltQualityMemo::lookup(Factor f, MIMEField *content_field, MIMEField *cached_accept_field, float *q)
+{
+  int c_len, ca_len;
+  const char *c  = memo_key_value(content_field, &c_len);
+  const char *ca = memo_key_value(cached_accept_field, &ca_len);
+
+  for (int i = 0; i < m_count[f]; i++) {
+    Entry &e = m_entries[f][i];
+    if (memo_key_equal(e.content, e.content_len, c, c_len) && memo_key_equal(e.cached_accept, e.cached_accept_len, ca, ca_len)) {
+      *q = e.q;
+      ++hits;
+      return true;
+    }
+  }
+  ++misses;
+  return false;
+}
+
+void
+AltQualityMemo::store(Factor f, MIMEField *content_field, MIMEField *cached_accept_field, float q)
+{
+  if (m_count[f] < SLOTS) {
+    Entry &e        = m_entries[f][m_count[f]++];
+    e.content       = memo_key_value(content_field, &e.content_len);
+    e.cached_accept = memo_key_value(cached_accept_field, &e.cached_accept_len);
+    e.q             = q;
+  }
+}
+
 /**
   Given a set of alternates, select the best match.
 
@@ -194,6 +248,8 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
     return 0;
   }
 
+  AltQualityMemo memo(client_request);
+
   for (int i = 0; i < alt_count; i++) {
     float Q;
     CacheHTTPInfo *obj       = cache_vector->get(i);
@@ -204,7 +260,7 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
       ink_assert(cached_request->valid());
       ink_assert(cached_response->valid());
 
-      Q = calculate_quality_of_match(http_config_params, client_request, cached_request, cached_response);
+      Q = calculate_quality_of_match(http_config_params, client_request, cached_request, cached_response, &memo);
 
       if (alt_count > 1) {
         if (t_now == 0) {
@@ -254,6 +310,7 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
       }
     }
   }
+  Debug("http_match", "[SelectFromAlternates] %d of %d Accept* checks reused", memo.hits, memo.hits + memo.misses);
   Debug("http_seq", "[SelectFromAlternates] Chosen alternate # %d", best_index);
   if (is_debug_tag_set("http_alts")) {
     ACQUIRE_PRINT_LOCK()
@@ -292,7 +349,8 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
 */
 float
 HttpTransactCache::calculate_quality_of_match(OverridableHttpConfigParams *http_config_param, HTTPHdr *client_request,
-                                              HTTPHdr *obj_client_request, HTTPHdr *obj_origin_server_response)
+                                              HTTPHdr *obj_client_request, HTTPHdr *obj_origin_server_response,
+                                              AltQualityMemo *memo)
 {
   // For PURGE requests, any alternate is good really.
   if (client_request->method_get_wksidx() == HTTP_WKSIDX_PURGE) {
@@ -328,13 +386,17 @@ HttpTransactCache::calculate_quality_of_match(OverridableHttpConfigParams *http_
     // Ignore it
     q[0] = 1.0;
   } else {
-    accept_field = client_request->field_find(MIME_FIELD_ACCEPT, MIME_LEN_ACCEPT);
+    accept_field =
+      memo ? memo->client_field(AltQualityMemo::ACCEPT) : client_request->field_find(MIME_FIELD_ACCEPT, MIME_LEN_ACCEPT);
 
     // A NULL Accept or a NULL Content-Type field are perfect matches.
     if (content_field == nullptr || accept_field == nullptr) {
       q[0] = 1.0; // TODO: Why should this not be 1.001 ?? // leif
-    } else {
+    } else if (!memo || !memo->lookup(AltQualityMemo::ACCEPT, content_field, nullptr, &q[0])) {
       q[0] = calculate_quality_of_accept_match(accept_field, content_field);
+      if (memo) {
+        memo->store(AltQualityMemo::ACCEPT, content_field, nullptr, q[0]);
+      }
     }
   }
 
@@ -344,15 +406,19 @@ HttpTransactCache::calculate_quality_of_match(OverridableHttpConfigParams *http_
       // Ignore it
       q[1] = 1.0;
     } else {
-      accept_field        = client_request->field_find(MIME_FIELD_ACCEPT_CHARSET, MIME_LEN_ACCEPT_CHARSET);
+      accept_field        = memo ? memo->client_field(AltQualityMemo::ACCEPT_CHARSET) :
+                                client_request->field_find(MIME_FIELD_ACCEPT_CHARSET, MIME_LEN_ACCEPT_CHARSET);
       cached_accept_field = obj_client_request->field_find(MIME_FIELD_ACCEPT_CHARSET, MIME_LEN_ACCEPT_CHARSET);
 
       // absence in both requests counts as exact match
       if (accept_field == nullptr && cached_accept_field == nullptr) {
         Debug("http_alternate", "Exact match for ACCEPT CHARSET (not in request nor cache)");
         q[1] = 1.001; // slightly higher weight to this guy
-      } else {
+      } else if (!memo || !memo->lookup(AltQualityMemo::ACCEPT_CHARSET, content_field, cached_accept_field, &q[1])) {
         q[1] = calculate_quality_of_accept_charset_match(accept_field, content_field, cached_accept_field);
+        if (memo) {
+          memo->store(AltQualityMemo::ACCEPT_CHARSET, content_field, cached_accept_field, q[1]);
+        }
       }
     }
 
@@ -362,7 +428,8 @@ HttpTransactCache::calculate_quality_of_match(OverridableHttpConfigParams *http_
         // Ignore it
         q[2] = 1.0;
       } else {
-        accept_field        = client_request->field_find(MIME_FIELD_ACCEPT_ENCODING, MIME_LEN_ACCEPT_ENCODING);
+        accept_field        = memo ? memo->client_field(AltQualityMemo::ACCEPT_ENCODING) :
+                                client_request->field_find(MIME_FIELD_ACCEPT_ENCODING, MIME_LEN_ACCEPT_ENCODING);
         content_field       = obj_origin_server_response->field_find(MIME_FIELD_CONTENT_ENCODING, MIME_LEN_CONTENT_ENCODING);
         cached_accept_field = obj_client_request->field_find(MIME_FIELD_ACCEPT_ENCODING, MIME_LEN_ACCEPT_ENCODING);
 
@@ -370,8 +437,11 @@ HttpTransactCache::calculate_quality_of_match(OverridableHttpConfigParams *http_
         if (accept_field == nullptr && cached_accept_field == nullptr) {
           Debug("http_alternate", "Exact match for ACCEPT ENCODING (not in request nor cache)");
           q[2] = 1.001; // slightly higher weight to this guy
-        } else {
+        } else if (!memo || !memo->lookup(AltQualityMemo::ACCEPT_ENCODING, content_field, cached_accept_field, &q[2])) {
           q[2] = calculate_quality_of_accept_encoding_match(accept_field, content_field, cached_accept_field);
+          if (memo) {
+            memo->store(AltQualityMemo::ACCEPT_ENCODING, content_field, cached_accept_field, q[2]);
+          }
         }
       }
 
@@ -381,7 +451,8 @@ HttpTransactCache::calculate_quality_of_match(OverridableHttpConfigParams *http_
           // Ignore it
           q[3] = 1.0;
         } else {
-          accept_field        = client_request->field_find(MIME_FIELD_ACCEPT_LANGUAGE, MIME_LEN_ACCEPT_LANGUAGE);
+          accept_field        = memo ? memo->client_field(AltQualityMemo::ACCEPT_LANGUAGE) :
+                                  client_request->field_find(MIME_FIELD_ACCEPT_LANGUAGE, MIME_LEN_ACCEPT_LANGUAGE);
           content_field       = obj_origin_server_response->field_find(MIME_FIELD_CONTENT_LANGUAGE, MIME_LEN_CONTENT_LANGUAGE);
           cached_accept_field = obj_client_request->field_find(MIME_FIELD_ACCEPT_LANGUAGE, MIME_LEN_ACCEPT_LANGUAGE);
 
@@ -389,8 +460,11 @@ HttpTransactCache::calculate_quality_of_match(OverridableHttpConfigParams *http_
           if (accept_field == nullptr && cached_accept_field == nullptr) {
             Debug("http_alternate", "Exact match for ACCEPT LANGUAGE (not in request nor cache)");
             q[3] = 1.001; // slightly higher weight to this guy
-          } else {
+          } else if (!memo || !memo->lookup(AltQualityMemo::ACCEPT_LANGUAGE, content_field, cached_accept_field, &q[3])) {
             q[3] = calculate_quality_of_accept_language_match(accept_field, content_field, cached_accept_field);
+            if (memo) {
+              memo->store(AltQualityMemo::ACCEPT_LANGUAGE, content_field, cached_accept_field, q[3]);
+            }
           }
         }
       }
@@ -45,6 +45,61 @@ enum Variability_t {
   VARIABILITY_ALL,
 };
 
+/**
+  Memo of the Accept* quality factors for one SelectFromAlternates() call.
+
+  Each factor computed by calculate_quality_of_match() depends only on the
+  client request, which is fixed for the whole selection, and on the raw
+  values of one cached request field and one cached response field. The
+  alternates of an object usually repeat those values (Vary on
+  Accept-Encoding and Accept-Language gives one Content-Encoding per
+  language), so a factor is computed once per distinct key instead of
+  re-parsing the client's Accept* lists for every alternate.
+
+*/
+class AltQualityMemo
+{
+public:
+  enum Factor {
+    ACCEPT = 0,
+    ACCEPT_CHARSET,
+    ACCEPT_ENCODING,
+    ACCEPT_LANGUAGE,
+    N_FACTORS,
+  };
+
+  // Distinct keys remembered per factor; further keys are just computed.
+  static const int SLOTS = 8;
+
+  explicit AltQualityMemo(HTTPHdr *client_request);
+
+  /// Accept* field of the client request for @a f, looked up once.
+  MIMEField *
+  client_field(Factor f) const
+  {
+    return m_client_fields[f];
+  }
+
+  bool lookup(Factor f, MIMEField *content_field, MIMEField *cached_accept_field, float *q);
+  void store(Factor f, MIMEField *content_field, MIMEField *cached_accept_field, float q);
+
+  int hits   = 0;
+  int misses = 0;
+
+private:
+  struct Entry {
+    const char *content;
+    const char *cached_accept;
+    int content_len; // -1 when the field is absent
+    int cached_accept_len;
+    float q;
+  };
+
+  MIMEField *m_client_fields[N_FACTORS];
+  Entry m_entries[N_FACTORS][SLOTS];
+  int m_count[N_FACTORS] = {0, 0, 0, 0};
+};
+
 class HttpTransactCache
 {
 public:
@@ -56,7 +111,8 @@ public:
                                   OverridableHttpConfigParams *cache_lookup_http_config_params);
 
   static float calculate_quality_of_match(OverridableHttpConfigParams *http_config_params, HTTPHdr *client_request,
-                                          HTTPHdr *obj_client_request, HTTPHdr *obj_origin_server_response);
+                                          HTTPHdr *obj_client_request, HTTPHdr *obj_origin_server_response,
+                                          AltQualityMemo *memo = nullptr);
 
   static float calculate_quality_of_accept_match(MIMEField *accept_field, MIMEField *content_field);
 
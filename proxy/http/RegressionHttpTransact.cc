@@ -23,6 +23,7 @@
 
 #include "ts/Regression.h"
 #include "HttpTransact.h"
+#include "HttpTransactCache.h"
 #include "HttpSM.h"
 
 void
@@ -136,3 +137,136 @@ REGRESSION_TEST(HttpTransact_handle_request)(RegressionTest * /* t */, int /* le
   // To be added..
   *pstatus = REGRESSION_TEST_PASSED;
 }
+
+static void
+parse_hdr(HTTPHdr *hdr, HTTPType type, const char *text)
+{
+  HTTPParser parser;
+  const char *start = text;
+  const char *end   = text + strlen(text);
+
+  hdr->create(type);
+  http_parser_init(&parser);
+  if (type == HTTP_TYPE_REQUEST) {
+    hdr->parse_req(&parser, &start, end, true);
+  } else {
+    hdr->parse_resp(&parser, &start, end, true);
+  }
+  http_parser_clear(&parser);
+}
+
+REGRESSION_TEST(HttpTransactCache_SelectFromAlternates)(RegressionTest *t, int /* level */, int *pstatus)
+{
+  // Vary on Accept-Encoding and Accept-Language: one alternate per (encoding, language).
+  static const struct {
+    const char *accept_encoding;
+    const char *content_encoding;
+  } encodings[] = {{"identity", nullptr}, {"gzip", "gzip"}, {"gzip, deflate, br", "br"}};
+  static const char *languages[] = {"en", "fr", "de", "ja", "es"};
+  const int n_enc                = sizeof(encodings) / sizeof(encodings[0]);
+  const int n_lang               = sizeof(languages) / sizeof(languages[0]);
+
+  OverridableHttpConfigParams params;
+  CacheHTTPInfoVector vector;
+  HTTPHdr client_request;
+  INK_MD5 key;
+  char buf[512];
+
+  *pstatus = REGRESSION_TEST_PASSED;
+
+  parse_hdr(&client_request, HTTP_TYPE_REQUEST,
+            "GET /page HTTP/1.1\r\nHost: example.com\r\nAccept-Encoding: gzip, deflate, br\r\nAccept-Language: de\r\n\r\n");
+
+  for (int e = 0; e < n_enc; e++) {
+    for (int l = 0; l < n_lang; l++) {
+      CacheHTTPInfo info;
+      HTTPHdr req, resp;
+
+      snprintf(buf, sizeof(buf), "GET /page HTTP/1.1\r\nHost: example.com\r\nAccept-Encoding: %s\r\nAccept-Language: %s\r\n\r\n",
+               encodings[e].accept_encoding, languages[l]);
+      parse_hdr(&req, HTTP_TYPE_REQUEST, buf);
+      snprintf(buf, sizeof(buf), "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nVary: Accept-Encoding, Accept-Language\r\n"
+                                 "Content-Language: %s\r\n%s%s%s\r\n",
+               languages[l], encodings[e].content_encoding ? "Content-Encoding: " : "",
+               encodings[e].content_encoding ? encodings[e].content_encoding : "", encodings[e].content_encoding ? "\r\n" : "");
+      parse_hdr(&resp, HTTP_TYPE_RESPONSE, buf);
+
+      info.create();
+      info.request_set(&req);
+      info.response_set(&resp);
+      MD5Context().hash_immediate(key, buf, strlen(buf));
+      info.object_key_set(key);
+      vector.insert(&info);
+
+      req.destroy();
+      resp.destroy();
+    }
+  }
+
+  // The memoized scores must be the same as scoring every alternate from scratch.
+  AltQualityMemo memo(&client_request);
+  for (int i = 0; i < vector.count(); i++) {
+    CacheHTTPInfo *obj = vector.get(i);
+    float plain =
+      HttpTransactCache::calculate_quality_of_match(&params, &client_request, obj->request_get(), obj->response_get());
+    float memoized =
+      HttpTransactCache::calculate_quality_of_match(&params, &client_request, obj->request_get(), obj->response_get(), &memo);
+
+    if (plain != memoized) {
+      rprintf(t, "alternate %d: memoized quality %g, expected %g\n", i, memoized, plain);
+      *pstatus = REGRESSION_TEST_FAILED;
+    }
+  }
+  if (memo.hits == 0) {
+    rprintf(t, "no Accept* check was reused across %d alternates\n", vector.count());
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  // Only the (br, de) alternate matches both Vary headers of the request.
+  int expected = (n_enc - 1) * n_lang + 2;
+  int selected = HttpTransactCache::SelectFromAlternates(&vector, &client_request, &params);
+  if (selected != expected) {
+    rprintf(t, "selected alternate %d, expected %d\n", selected, expected);
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  vector.clear();
+  client_request.destroy();
+}
+
+// sizeof(HttpSM) on LP64 builds. Every in-flight transaction pays for all of it, so
+//  a member that is only needed now and then belongs in State::arena instead.
+static const size_t HTTP_SM_SIZE_LIMIT = 6592;
+
+REGRESSION_TEST(HttpSM_MemoryFootprint)(RegressionTest *t, int /* level */, int *pstatus)
+{
+  HttpSM sm;
+  *pstatus = REGRESSION_TEST_PASSED;
+
+  if (sizeof(HttpSM) > HTTP_SM_SIZE_LIMIT) {
+    rprintf(t, "sizeof(HttpSM) grew to %zu bytes, the limit is %zu\n", sizeof(HttpSM), HTTP_SM_SIZE_LIMIT);
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  setup_client_request(&sm, "http", "GET / HTTP/1.1\r\nHost: abc.com\r\n\r\n");
+
+  // Without config overrides or SRV lookups nothing is allocated on the side.
+  if (sm.t_state.my_txn_conf != nullptr || sm.t_state.dns_info.srv_hostname != nullptr ||
+      sm.memory_footprint() != (int64_t)sizeof(HttpSM)) {
+    rprintf(t, "a plain transaction takes %" PRId64 " bytes, expected %zu\n", sm.memory_footprint(), sizeof(HttpSM));
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  sm.t_state.setup_per_txn_configs();
+  if (sm.t_state.my_txn_conf == nullptr || sm.t_state.txn_conf != sm.t_state.my_txn_conf ||
+      memcmp(sm.t_state.txn_conf, &sm.t_state.http_config_param->oride, sizeof(OverridableHttpConfigParams)) != 0) {
+    rprintf(t, "per transaction configuration was not copied from the global one\n");
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+  if (sm.memory_footprint() < (int64_t)(sizeof(HttpSM) + sizeof(OverridableHttpConfigParams))) {
+    rprintf(t, "overridden configuration is not counted, footprint is %" PRId64 " bytes\n", sm.memory_footprint());
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  sm.t_state.destroy();
+}
@@ -91,9 +91,11 @@ BUILD_TABLE_INFO::~BUILD_TABLE_INFO()
 void
 BUILD_TABLE_INFO::reset()
 {
+  // Only the leading paramc / argc slots are ever filled, so don't walk the whole
+  // (large) vectors for every line of remap.config.
+  clear_xstr_array(this->paramv, std::min(this->paramc, BUILD_TABLE_MAX_ARGS));
+  clear_xstr_array(this->argv, std::min(this->argc, BUILD_TABLE_MAX_ARGS));
   this->paramc = this->argc = 0;
-  clear_xstr_array(this->paramv, sizeof(this->paramv) / sizeof(char *));
-  clear_xstr_array(this->argv, sizeof(this->argv) / sizeof(char *));
 }
 
 static const char *
@@ -1210,7 +1212,8 @@ remap_parse_config_bti(const char *path, BUILD_TABLE_INFO *bti)
     map_to_start = map_to;
     tmp          = map_to;
 
-    new_mapping->toUrl.create(nullptr);
+    // The destination URL shares the source URL's heap, halving the per rule heap overhead.
+    new_mapping->toUrl.create(new_mapping->fromURL.m_heap);
     rparse                   = new_mapping->toUrl.parse_no_path_component_breakdown(tmp, length);
     map_to_start[origLength] = '\0'; // Unwhack
 
@@ -1365,7 +1368,7 @@ remap_parse_config_bti(const char *path, BUILD_TABLE_INFO *bti)
             u_mapping->fromURL.create(nullptr);
             u_mapping->fromURL.copy(&new_mapping->fromURL);
             u_mapping->fromURL.host_set(ipb, strlen(ipb));
-            u_mapping->toUrl.create(nullptr);
+            u_mapping->toUrl.create(u_mapping->fromURL.m_heap);
             u_mapping->toUrl.copy(&new_mapping->toUrl);
 
             if (bti->paramv[3] != nullptr) {
@@ -112,9 +112,13 @@ url_mapping::~url_mapping()
     delete afr;
   }
 
-  // Destroy the URLs
+  // Destroy the URLs, toUrl normally lives in the fromURL heap.
+  if (toUrl.m_heap == fromURL.m_heap) {
+    toUrl.clear();
+  } else {
+    toUrl.destroy();
+  }
   fromURL.destroy();
-  toUrl.destroy();
 }
 
 void
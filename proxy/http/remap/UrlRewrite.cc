@@ -591,6 +591,7 @@ UrlRewrite::_addToStore(MappingsStore &store, url_mapping *new_mapping, RegexMap
 
   new_mapping->setRank(count); // Use the mapping rules number count for rank
   if (is_cur_mapping_regex) {
+    reg_map->literal_id = store.regex_filter.add(src_host);
     store.regex_list.enqueue(reg_map);
     retval = true;
   } else {
@@ -796,7 +797,7 @@ UrlRewrite::_mappingLookup(MappingsStore &mappings, URL *request_url, int reques
     mapping_container.set(mapping);
     retval = true;
   }
-  if (_regexMappingLookup(mappings.regex_list, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
+  if (_regexMappingLookup(mappings, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
                           mapping_container)) {
     Debug("url_rewrite", "Using regex mapping with rank %d", (mapping_container.getMapping())->getRank());
     retval = true;
@@ -853,10 +854,11 @@ lOverFlow:
 }
 
 bool
-UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
+UrlRewrite::_regexMappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host,
                                 int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container)
 {
   bool retval = false;
+  RegexLiteralFilter::Scan literal_scan(mappings.regex_filter, request_host);
 
   if (rank_ceiling == -1) { // we will now look at all regex mappings
     rank_ceiling = INT_MAX;
@@ -879,7 +881,7 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
   }
 
   // Loop over the entire linked list, or until we're satisfied
-  forl_LL(RegexMapping, list_iter, regex_mappings)
+  forl_LL(RegexMapping, list_iter, mappings.regex_list)
   {
     int reg_map_rank = list_iter->url_map->getRank();
 
@@ -907,6 +909,11 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
       continue;
     }
 
+    if (!literal_scan.may_match(list_iter->literal_id)) {
+      Debug("url_rewrite_regex", "Skipping regex with rank %d as request host lacks a literal it requires", reg_map_rank);
+      continue;
+    }
+
     int matches_info[MAX_REGEX_SUBS * 3];
     bool match_result = list_iter->regular_expression.exec(request_host, request_host_len, matches_info, countof(matches_info));
 
@@ -90,6 +90,10 @@ public:
     int substitution_markers[MAX_REGEX_SUBS];
     int substitution_ids[MAX_REGEX_SUBS];
 
+    // id of the literal every host matching the regex contains, in the
+    // regex_filter of the store it is in, -1 if there is none
+    int literal_id;
+
     LINK(RegexMapping, link);
   };
 
@@ -98,6 +102,7 @@ public:
   struct MappingsStore {
     InkHashTable *hash_lookup;
     RegexMappingList regex_list;
+    RegexLiteralFilter regex_filter;
     bool
     empty()
     {
@@ -181,7 +186,7 @@ private:
   bool _mappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host, int request_host_len,
                       UrlMappingContainer &mapping_container);
   url_mapping *_tableLookup(InkHashTable *h_table, URL *request_url, int request_port, char *request_host, int request_host_len);
-  bool _regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
+  bool _regexMappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host,
                            int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container);
   int _expandSubstitutions(int *matches_info, const RegexMapping *reg_map, const char *matched_string, char *dest_buf,
                            int dest_buf_size);
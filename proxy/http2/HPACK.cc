@@ -166,6 +166,92 @@ static const StaticTable STATIC_TABLE[] = {{"", ""},
                                            {"via", ""},
                                            {"www-authenticate", ""}};
 
+static const int STATIC_TABLE_HASH_SIZE = 256; // Power of 2
+
+// Case insensitive FNV-1a of a header name, the base of every table lookup.
+static inline uint32_t
+hpack_name_hash(const char *name, int name_len, uint32_t seed)
+{
+  uint32_t hash = 2166136261U ^ seed;
+
+  for (int i = 0; i < name_len; ++i) {
+    hash ^= static_cast<uint8_t>(ParseRules::ink_tolower(name[i]));
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+// Extends a name hash with the value, case sensitive.
+static inline uint32_t
+hpack_field_hash(uint32_t name_hash, const char *value, int value_len)
+{
+  uint32_t hash = name_hash;
+
+  for (int i = 0; i < value_len; ++i) {
+    hash ^= static_cast<uint8_t>(value[i]);
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+// The low bits of FNV are weak, mix them before picking a bucket.
+static inline uint32_t
+hpack_hash_mix(uint32_t hash)
+{
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bU;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+//
+// Perfect hash of the static table names. The seed is searched for once, at startup, so that every
+// distinct name gets a slot of its own. Entries sharing a name (":status" etc.) are consecutive in
+// the table, the slot keeps the range of them.
+//
+struct StaticTableIndex {
+  struct Slot {
+    uint8_t first;
+    uint8_t last;
+  };
+
+  StaticTableIndex()
+  {
+    for (seed = 0; !build(); ++seed) {
+      ;
+    }
+  }
+
+  bool
+  build()
+  {
+    memset(slots, 0, sizeof(slots));
+    for (int i = 1; i < TS_HPACK_STATIC_TABLE_ENTRY_NUM; ++i) {
+      Slot &slot = slots[hpack_hash_mix(hpack_name_hash(STATIC_TABLE[i].name, STATIC_TABLE[i].name_size, seed)) &
+                         (STATIC_TABLE_HASH_SIZE - 1)];
+      if (!slot.first) {
+        slot.first = slot.last = i;
+      } else if (strcmp(STATIC_TABLE[slot.first].name, STATIC_TABLE[i].name) == 0) {
+        slot.last = i;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const Slot &
+  find(uint32_t name_hash) const
+  {
+    return slots[hpack_hash_mix(name_hash) & (STATIC_TABLE_HASH_SIZE - 1)];
+  }
+
+  uint32_t seed;
+  Slot slots[STATIC_TABLE_HASH_SIZE];
+};
+
+static const StaticTableIndex STATIC_TABLE_INDEX;
+
 /******************
  * Local functions
  ******************/
@@ -219,44 +305,38 @@ HpackLookupResult
 HpackIndexingTable::lookup(const char *name, int name_len, const char *value, int value_len) const
 {
   HpackLookupResult result;
-  const int entry_num = TS_HPACK_STATIC_TABLE_ENTRY_NUM + _dynamic_table->length();
-
-  for (int index = 1; index < entry_num; ++index) {
-    const char *table_name, *table_value;
-    int table_name_len = 0, table_value_len = 0;
-
-    if (index < TS_HPACK_STATIC_TABLE_ENTRY_NUM) {
-      // static table
-      table_name      = STATIC_TABLE[index].name;
-      table_value     = STATIC_TABLE[index].value;
-      table_name_len  = STATIC_TABLE[index].name_size;
-      table_value_len = STATIC_TABLE[index].value_size;
-    } else {
-      // dynamic table
-      const MIMEField *m_field = _dynamic_table->get_header_field(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
-
-      table_name  = m_field->name_get(&table_name_len);
-      table_value = m_field->value_get(&table_value_len);
-    }
-
-    // Check whether name (and value) are matched
-    if (ptr_len_casecmp(name, name_len, table_name, table_name_len) == 0) {
-      if ((value_len == table_value_len) && (memcmp(value, table_value, value_len) == 0)) {
+  const uint32_t name_hash                  = hpack_name_hash(name, name_len, STATIC_TABLE_INDEX.seed);
+  const uint32_t field_hash                 = hpack_field_hash(name_hash, value, value_len);
+  const StaticTableIndex::Slot &static_slot = STATIC_TABLE_INDEX.find(name_hash);
+  const bool static_name =
+    static_slot.first &&
+    ptr_len_casecmp(name, name_len, STATIC_TABLE[static_slot.first].name, STATIC_TABLE[static_slot.first].name_size) == 0;
+  int index;
+
+  // Prefer an exact match to a name match, and the static table to the dynamic table.
+  if (static_name) {
+    for (index = static_slot.first; index <= static_slot.last; ++index) {
+      if (value_len == STATIC_TABLE[index].value_size && memcmp(value, STATIC_TABLE[index].value, value_len) == 0) {
         result.index      = index;
+        result.index_type = HpackIndex::STATIC;
         result.match_type = HpackMatch::EXACT;
-        break;
-      } else if (!result.index) {
-        result.index      = index;
-        result.match_type = HpackMatch::NAME;
+        return result;
       }
     }
   }
-  if (result.match_type != HpackMatch::NONE) {
-    if (result.index < TS_HPACK_STATIC_TABLE_ENTRY_NUM) {
-      result.index_type = HpackIndex::STATIC;
-    } else {
-      result.index_type = HpackIndex::DYNAMIC;
-    }
+
+  if ((index = _dynamic_table->lookup(name_hash, name, name_len, field_hash, value, value_len, true)) >= 0) {
+    result.index      = TS_HPACK_STATIC_TABLE_ENTRY_NUM + index;
+    result.index_type = HpackIndex::DYNAMIC;
+    result.match_type = HpackMatch::EXACT;
+  } else if (static_name) {
+    result.index      = static_slot.first;
+    result.index_type = HpackIndex::STATIC;
+    result.match_type = HpackMatch::NAME;
+  } else if ((index = _dynamic_table->lookup(name_hash, name, name_len, field_hash, value, value_len, false)) >= 0) {
+    result.index      = TS_HPACK_STATIC_TABLE_ENTRY_NUM + index;
+    result.index_type = HpackIndex::DYNAMIC;
+    result.match_type = HpackMatch::NAME;
   }
 
   return result;
@@ -276,12 +356,10 @@ HpackIndexingTable::get_header_field(uint32_t index, MIMEFieldWrapper &field) co
     field.value_set(STATIC_TABLE[index].value, STATIC_TABLE[index].value_size);
   } else if (index < TS_HPACK_STATIC_TABLE_ENTRY_NUM + _dynamic_table->length()) {
     // dynamic table
-    const MIMEField *m_field = _dynamic_table->get_header_field(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
-
+    const char *name, *value;
     int name_len, value_len;
-    const char *name  = m_field->name_get(&name_len);
-    const char *value = m_field->value_get(&value_len);
 
+    _dynamic_table->get_header_field(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM, &name, &name_len, &value, &value_len);
     field.name_set(name, name_len);
     field.value_set(value, value_len);
   } else {
@@ -318,18 +396,51 @@ HpackIndexingTable::update_maximum_size(uint32_t new_size)
   return _dynamic_table->update_maximum_size(new_size);
 }
 
-const MIMEField *
-HpackDynamicTable::get_header_field(uint32_t index) const
+HpackDynamicTable::~HpackDynamicTable()
 {
-  return _headers.get(index);
+  while (_count) {
+    _evict();
+  }
+  ats_free(_entries);
+  ats_free(_names);
+  ats_free(_fields);
+}
+
+HpackDynamicTable::Entry &
+HpackDynamicTable::_entry(uint64_t seq) const
+{
+  return _entries[seq & (_capacity - 1)];
+}
+
+bool
+HpackDynamicTable::get_header_field(uint32_t index, const char **name, int *name_len, const char **value, int *value_len) const
+{
+  if (index >= _count) {
+    return false;
+  }
+
+  const Entry &entry = _entry(_next_seq - 1 - index);
+
+  *name      = entry.name;
+  *name_len  = entry.name_len;
+  *value     = entry.value;
+  *value_len = entry.value_len;
+  return true;
 }
 
 void
 HpackDynamicTable::add_header_field(const MIMEField *field)
 {
   int name_len, value_len;
-  const char *name     = field->name_get(&name_len);
-  const char *value    = field->value_get(&value_len);
+  const char *name  = field->name_get(&name_len);
+  const char *value = field->value_get(&value_len);
+
+  add_header_field(name, name_len, value, value_len);
+}
+
+void
+HpackDynamicTable::add_header_field(const char *name, int name_len, const char *value, int value_len)
+{
   uint32_t header_size = ADDITIONAL_OCTETS + name_len + value_len;
 
   if (header_size > _maximum_size) {
@@ -337,28 +448,132 @@ HpackDynamicTable::add_header_field(const MIMEField *field)
     // It is not an error to attempt to add an entry that is larger than
     // the maximum size; an attempt to add an entry larger than the entire
     // table causes the table to be emptied of all existing entries.
-    _headers.clear();
-    _mhdr->fields_clear();
-    _current_size = 0;
+    while (_count) {
+      _evict();
+    }
+    return;
+  }
+
+  // Copy first, the new entry may refer to the name of an entry about to be evicted.
+  char *data = static_cast<char *>(ats_malloc(name_len + value_len));
+  memcpy(data, name, name_len);
+  memcpy(data + name_len, value, value_len);
+
+  while (_current_size + header_size > _maximum_size) {
+    _evict();
+  }
+
+  if (_count == _capacity) {
+    uint32_t capacity = _capacity ? _capacity * 2 : 16;
+    Entry *entries    = static_cast<Entry *>(ats_malloc(capacity * sizeof(Entry)));
+
+    for (uint64_t seq = _next_seq - _count; seq < _next_seq; ++seq) {
+      entries[seq & (capacity - 1)] = _entry(seq);
+    }
+    ats_free(_entries);
+    _entries  = entries;
+    _capacity = capacity;
+    if (_names) {
+      _rehash();
+    }
+  }
+
+  uint64_t seq = _next_seq++;
+  Entry &entry = _entry(seq);
+
+  entry.name      = data;
+  entry.name_len  = name_len;
+  entry.value     = data + name_len;
+  entry.value_len = value_len;
+  ++_count;
+  _current_size += header_size;
+
+  if (_names) {
+    _link(seq);
+  }
+}
+
+int
+HpackDynamicTable::lookup(uint32_t name_hash, const char *name, int name_len, uint32_t field_hash, const char *value,
+                          int value_len, bool exact)
+{
+  if (_count == 0) {
+    return -1;
+  }
+  if (!_names) {
+    _rehash();
+  }
+
+  const uint64_t oldest = _next_seq - _count;
+  uint64_t next;
+
+  if (exact) {
+    next = _fields[hpack_hash_mix(field_hash) & (_n_buckets - 1)];
   } else {
-    _current_size += header_size;
-    while (_current_size > _maximum_size) {
-      int last_name_len, last_value_len;
-      MIMEField *last_field = _headers.last();
+    next = _names[hpack_hash_mix(name_hash) & (_n_buckets - 1)];
+  }
 
-      last_field->name_get(&last_name_len);
-      last_field->value_get(&last_value_len);
-      _current_size -= ADDITIONAL_OCTETS + last_name_len + last_value_len;
+  // Chains run from the newest entry to the oldest, stop once they reach evicted entries.
+  while (next > oldest) {
+    const uint64_t seq = next - 1;
+    const Entry &entry = _entry(seq);
 
-      _headers.remove_index(_headers.length() - 1);
-      _mhdr->field_delete(last_field, false);
+    if (exact) {
+      if (entry.field_hash == field_hash && entry.value_len == value_len && memcmp(entry.value, value, value_len) == 0 &&
+          ptr_len_casecmp(entry.name, entry.name_len, name, name_len) == 0) {
+        return _next_seq - 1 - seq;
+      }
+      next = entry.field_next;
+    } else {
+      if (entry.name_hash == name_hash && ptr_len_casecmp(entry.name, entry.name_len, name, name_len) == 0) {
+        return _next_seq - 1 - seq;
+      }
+      next = entry.name_next;
     }
+  }
+
+  return -1;
+}
+
+void
+HpackDynamicTable::_evict()
+{
+  Entry &entry = _entry(_next_seq - _count);
+
+  _current_size -= ADDITIONAL_OCTETS + entry.name_len + entry.value_len;
+  ats_free(entry.name);
+  entry.name = entry.value = nullptr;
+  --_count;
+}
+
+void
+HpackDynamicTable::_link(uint64_t seq)
+{
+  Entry &entry = _entry(seq);
 
-    MIMEField *new_field = _mhdr->field_create(name, name_len);
-    new_field->value_set(_mhdr->m_heap, _mhdr->m_mime, value, value_len);
-    _mhdr->field_attach(new_field);
-    // XXX Because entire Vec instance is copied, Its too expensive!
-    _headers.insert(0, new_field);
+  entry.name_hash  = hpack_name_hash(entry.name, entry.name_len, STATIC_TABLE_INDEX.seed);
+  entry.field_hash = hpack_field_hash(entry.name_hash, entry.value, entry.value_len);
+
+  uint64_t &name_bucket  = _names[hpack_hash_mix(entry.name_hash) & (_n_buckets - 1)];
+  uint64_t &field_bucket = _fields[hpack_hash_mix(entry.field_hash) & (_n_buckets - 1)];
+
+  entry.name_next  = name_bucket;
+  entry.field_next = field_bucket;
+  name_bucket      = seq + 1;
+  field_bucket     = seq + 1;
+}
+
+void
+HpackDynamicTable::_rehash()
+{
+  ats_free(_names);
+  ats_free(_fields);
+  _n_buckets = _capacity * 2;
+  _names     = static_cast<uint64_t *>(ats_calloc(_n_buckets, sizeof(uint64_t)));
+  _fields    = static_cast<uint64_t *>(ats_calloc(_n_buckets, sizeof(uint64_t)));
+
+  for (uint64_t seq = _next_seq - _count; seq < _next_seq; ++seq) {
+    _link(seq);
   }
 }
 
@@ -385,18 +600,10 @@ bool
 HpackDynamicTable::update_maximum_size(uint32_t new_size)
 {
   while (_current_size > new_size) {
-    if (_headers.n <= 0) {
+    if (_count == 0) {
       return false;
     }
-    int last_name_len, last_value_len;
-    MIMEField *last_field = _headers.last();
-
-    last_field->name_get(&last_name_len);
-    last_field->value_get(&last_value_len);
-    _current_size -= ADDITIONAL_OCTETS + last_name_len + last_value_len;
-
-    _headers.remove_index(_headers.length() - 1);
-    _mhdr->field_delete(last_field, false);
+    _evict();
   }
 
   _maximum_size = new_size;
@@ -406,7 +613,7 @@ HpackDynamicTable::update_maximum_size(uint32_t new_size)
 uint32_t
 HpackDynamicTable::length() const
 {
-  return _headers.length();
+  return _count;
 }
 
 //
@@ -441,31 +648,21 @@ encode_integer(uint8_t *buf_start, const uint8_t *buf_end, uint32_t value, uint8
   return p - buf_start;
 }
 
+//
+// [RFC 7541] 5.2. String Literal Representation
+// The string is encoded straight into the output, Huffman coded unless that would make it longer.
+//
 int64_t
 encode_string(uint8_t *buf_start, const uint8_t *buf_end, const char *value, size_t value_len)
 {
-  uint8_t *p       = buf_start;
-  bool use_huffman = true;
-  char *data       = nullptr;
-  int64_t data_len = 0;
-
-  // TODO Choose whether to use Huffman encoding wisely
-
-  if (use_huffman && value_len) {
-    data = static_cast<char *>(ats_malloc(value_len * 4));
-    if (data == nullptr) {
-      return -1;
-    }
-    data_len = huffman_encode(reinterpret_cast<uint8_t *>(data), reinterpret_cast<const uint8_t *>(value), value_len);
-  }
+  uint8_t *p                = buf_start;
+  const int64_t huffman_len = huffman_encode_length(reinterpret_cast<const uint8_t *>(value), value_len);
+  const bool use_huffman    = huffman_len <= static_cast<int64_t>(value_len);
+  const int64_t data_len    = use_huffman ? huffman_len : value_len;
 
   // Length
   const int64_t len = encode_integer(p, buf_end, data_len, 7);
   if (len == -1) {
-    if (use_huffman) {
-      ats_free(data);
-    }
-
     return -1;
   }
 
@@ -475,22 +672,16 @@ encode_string(uint8_t *buf_start, const uint8_t *buf_end, const char *value, siz
   p += len;
 
   if (buf_end < p || buf_end - p < data_len) {
-    if (use_huffman) {
-      ats_free(data);
-    }
-
     return -1;
   }
 
   // Value
-  if (data_len) {
-    memcpy(p, data, data_len);
-    p += data_len;
-  }
-
   if (use_huffman) {
-    ats_free(data);
+    huffman_encode(p, reinterpret_cast<const uint8_t *>(value), value_len);
+  } else {
+    memcpy(p, value, value_len);
   }
+  p += data_len;
 
   return p - buf_start;
 }
@@ -607,16 +798,19 @@ encode_literal_header_field_with_new_name(uint8_t *buf_start, const uint8_t *buf
 
   // Convert field name to lower case to follow HTTP2 spec.
   // This conversion is needed because WKSs in MIMEFields is old fashioned
-  Arena arena;
+  char name_buf[128];
   int name_len;
   const char *name = header.name_get(&name_len);
-  char *lower_name = arena.str_store(name, name_len);
+  char *lower_name = name_len <= static_cast<int>(sizeof(name_buf)) ? name_buf : static_cast<char *>(ats_malloc(name_len));
   for (int i = 0; i < name_len; i++) {
-    lower_name[i] = ParseRules::ink_tolower(lower_name[i]);
+    lower_name[i] = ParseRules::ink_tolower(name[i]);
   }
 
   // Name String
   len = encode_string(p, buf_end, lower_name, name_len);
+  if (lower_name != name_buf) {
+    ats_free(lower_name);
+  }
   if (len == -1) {
     return -1;
   }
@@ -961,6 +1155,35 @@ hpack_decode_header_block(HpackIndexingTable &indexing_table, HTTPHdr *hdr, cons
   }
 }
 
+//
+// Choose field representation (See RFC7541 7.1.3)
+//
+static HpackField
+hpack_encoding_field_type(const MIMEField *field, int value_len, const HpackIndexingTable &indexing_table)
+{
+  int name_len;
+  field->name_get(&name_len);
+
+  // - Authorization header obviously should not be indexed
+  // - Short Cookie header should not be indexed because of low entropy
+  if ((field->m_wks_idx == MIME_WKSIDX_COOKIE && value_len < 20) || field->m_wks_idx == MIME_WKSIDX_AUTHORIZATION) {
+    return HpackField::NEVERINDEX_LITERAL;
+  }
+
+  // - Values that change with every message would only evict entries that get reused
+  if (field->m_wks_idx == MIME_WKSIDX_CONTENT_LENGTH || field->m_wks_idx == MIME_WKSIDX_AGE ||
+      field->m_wks_idx == MIME_WKSIDX_ETAG) {
+    return HpackField::NOINDEX_LITERAL;
+  }
+
+  // - So would a field taking more than half of the dynamic table
+  if (ADDITIONAL_OCTETS + name_len + value_len > indexing_table.maximum_size() / 2) {
+    return HpackField::NOINDEX_LITERAL;
+  }
+
+  return HpackField::INDEXED_LITERAL;
+}
+
 int64_t
 hpack_encode_header_block(HpackIndexingTable &indexing_table, uint8_t *out_buf, const size_t out_buf_len, HTTPHdr *hdr,
                           int32_t maximum_table_size)
@@ -983,29 +1206,20 @@ hpack_encode_header_block(HpackIndexingTable &indexing_table, uint8_t *out_buf,
 
   MIMEFieldIter field_iter;
   for (MIMEField *field = hdr->iter_get_first(&field_iter); field != nullptr; field = hdr->iter_get_next(&field_iter)) {
-    HpackField field_type;
     MIMEFieldWrapper header(field, hdr->m_heap, hdr->m_http->m_fields_impl);
     int name_len;
     int value_len;
-    const char *name = header.name_get(&name_len);
-    header.value_get(&value_len);
-    // Choose field representation (See RFC7541 7.1.3)
-    // - Authorization header obviously should not be indexed
-    // - Short Cookie header should not be indexed because of low entropy
-    if ((ptr_len_casecmp(name, name_len, MIME_FIELD_COOKIE, MIME_LEN_COOKIE) == 0 && value_len < 20) ||
-        (ptr_len_casecmp(name, name_len, MIME_FIELD_AUTHORIZATION, MIME_LEN_AUTHORIZATION) == 0)) {
-      field_type = HpackField::NEVERINDEX_LITERAL;
-    } else {
-      field_type = HpackField::INDEXED_LITERAL;
-    }
-    const HpackLookupResult result = indexing_table.lookup(header);
+    const char *name               = header.name_get(&name_len);
+    const char *value              = header.value_get(&value_len);
+    const HpackLookupResult result = indexing_table.lookup(name, name_len, value, value_len);
     switch (result.match_type) {
     case HpackMatch::NONE:
-      written = encode_literal_header_field_with_new_name(cursor, out_buf_end, header, indexing_table, field_type);
+      written = encode_literal_header_field_with_new_name(cursor, out_buf_end, header, indexing_table,
+                                                          hpack_encoding_field_type(field, value_len, indexing_table));
       break;
     case HpackMatch::NAME:
-      written =
-        encode_literal_header_field_with_indexed_name(cursor, out_buf_end, header, result.index, indexing_table, field_type);
+      written = encode_literal_header_field_with_indexed_name(cursor, out_buf_end, header, result.index, indexing_table,
+                                                              hpack_encoding_field_type(field, value_len, indexing_table));
       break;
     case HpackMatch::EXACT:
       written = encode_indexed_header_field(cursor, out_buf_end, result.index);
@@ -25,7 +25,6 @@
 #define __HPACK_H__
 
 #include "ts/ink_platform.h"
-#include "ts/Vec.h"
 #include "ts/Diags.h"
 #include "HTTP.h"
 
@@ -102,25 +101,25 @@ private:
 };
 
 // [RFC 7541] 2.3.2. Dynamic Table
+//
+// Entries live in a ring, index 0 being the newest, and each entry keeps its name and value in a
+// single allocation. Each entry gets a sequence number when it is added. The table can also index
+// its entries by a hash of the name and of the name and value pair. The index is only built once
+// lookup() is first called, so tables that only decode do not pay for it. Hash chains link entries
+// from newest to oldest. An evicted entry is never unlinked, the walk simply stops at the first
+// sequence number older than the oldest live entry.
 class HpackDynamicTable
 {
 public:
-  HpackDynamicTable(uint32_t size) : _current_size(0), _maximum_size(size)
-  {
-    _mhdr = new MIMEHdr();
-    _mhdr->create();
-  }
-
-  ~HpackDynamicTable()
-  {
-    _headers.clear();
-    _mhdr->fields_clear();
-    _mhdr->destroy();
-    delete _mhdr;
-  }
+  HpackDynamicTable(uint32_t size) : _maximum_size(size) {}
+  ~HpackDynamicTable();
 
-  const MIMEField *get_header_field(uint32_t index) const;
+  bool get_header_field(uint32_t index, const char **name, int *name_len, const char **value, int *value_len) const;
+  void add_header_field(const char *name, int name_len, const char *value, int value_len);
   void add_header_field(const MIMEField *field);
+  // Index of the newest entry matching the name and value if @a exact is set, else only the name. -1 if none.
+  int lookup(uint32_t name_hash, const char *name, int name_len, uint32_t field_hash, const char *value, int value_len,
+             bool exact);
 
   uint32_t maximum_size() const;
   uint32_t size() const;
@@ -129,11 +128,32 @@ public:
   uint32_t length() const;
 
 private:
-  uint32_t _current_size;
+  struct Entry {
+    char *name;
+    char *value;
+    int name_len;
+    int value_len;
+    uint32_t name_hash;
+    uint32_t field_hash;
+    uint64_t name_next;  // Sequence number + 1 of the next older entry in the same name bucket.
+    uint64_t field_next; // Sequence number + 1 of the next older entry in the same field bucket.
+  };
+
+  Entry &_entry(uint64_t seq) const;
+  void _evict();
+  void _link(uint64_t seq);
+  void _rehash();
+
+  uint32_t _current_size = 0;
   uint32_t _maximum_size;
 
-  MIMEHdr *_mhdr;
-  Vec<MIMEField *> _headers;
+  Entry *_entries     = nullptr;
+  uint32_t _capacity  = 0; // Power of 2
+  uint32_t _count     = 0;
+  uint64_t _next_seq  = 0;
+  uint64_t *_names    = nullptr; // Buckets, the sequence number + 1 of the newest entry.
+  uint64_t *_fields   = nullptr;
+  uint32_t _n_buckets = 0; // Power of 2, twice the ring capacity.
 };
 
 // [RFC 7541] 2.3. Indexing Table
@@ -50,19 +50,27 @@ static const int HTTP2_MAX_TABLE_SIZE_LIMIT = 64 * 1024;
 
 // Statistics
 RecRawStatBlock *http2_rsb;
-static const char *const HTTP2_STAT_CURRENT_CLIENT_SESSION_NAME  = "proxy.process.http2.current_client_sessions";
-static const char *const HTTP2_STAT_CURRENT_CLIENT_STREAM_NAME   = "proxy.process.http2.current_client_streams";
-static const char *const HTTP2_STAT_TOTAL_CLIENT_STREAM_NAME     = "proxy.process.http2.total_client_streams";
-static const char *const HTTP2_STAT_TOTAL_TRANSACTIONS_TIME_NAME = "proxy.process.http2.total_transactions_time";
-static const char *const HTTP2_STAT_TOTAL_CLIENT_CONNECTION_NAME = "proxy.process.http2.total_client_connections";
-static const char *const HTTP2_STAT_CONNECTION_ERRORS_NAME       = "proxy.process.http2.connection_errors";
-static const char *const HTTP2_STAT_STREAM_ERRORS_NAME           = "proxy.process.http2.stream_errors";
-static const char *const HTTP2_STAT_SESSION_DIE_DEFAULT_NAME     = "proxy.process.http2.session_die_default";
-static const char *const HTTP2_STAT_SESSION_DIE_OTHER_NAME       = "proxy.process.http2.session_die_other";
-static const char *const HTTP2_STAT_SESSION_DIE_ACTIVE_NAME      = "proxy.process.http2.session_die_active";
-static const char *const HTTP2_STAT_SESSION_DIE_INACTIVE_NAME    = "proxy.process.http2.session_die_inactive";
-static const char *const HTTP2_STAT_SESSION_DIE_EOS_NAME         = "proxy.process.http2.session_die_eos";
-static const char *const HTTP2_STAT_SESSION_DIE_ERROR_NAME       = "proxy.process.http2.session_die_error";
+static const char *const HTTP2_STAT_CURRENT_CLIENT_SESSION_NAME   = "proxy.process.http2.current_client_sessions";
+static const char *const HTTP2_STAT_CURRENT_CLIENT_STREAM_NAME    = "proxy.process.http2.current_client_streams";
+static const char *const HTTP2_STAT_TOTAL_CLIENT_STREAM_NAME      = "proxy.process.http2.total_client_streams";
+static const char *const HTTP2_STAT_TOTAL_TRANSACTIONS_TIME_NAME  = "proxy.process.http2.total_transactions_time";
+static const char *const HTTP2_STAT_TOTAL_CLIENT_CONNECTION_NAME  = "proxy.process.http2.total_client_connections";
+static const char *const HTTP2_STAT_CONNECTION_ERRORS_NAME        = "proxy.process.http2.connection_errors";
+static const char *const HTTP2_STAT_STREAM_ERRORS_NAME            = "proxy.process.http2.stream_errors";
+static const char *const HTTP2_STAT_SESSION_DIE_DEFAULT_NAME      = "proxy.process.http2.session_die_default";
+static const char *const HTTP2_STAT_SESSION_DIE_OTHER_NAME        = "proxy.process.http2.session_die_other";
+static const char *const HTTP2_STAT_SESSION_DIE_ACTIVE_NAME       = "proxy.process.http2.session_die_active";
+static const char *const HTTP2_STAT_SESSION_DIE_INACTIVE_NAME     = "proxy.process.http2.session_die_inactive";
+static const char *const HTTP2_STAT_SESSION_DIE_EOS_NAME          = "proxy.process.http2.session_die_eos";
+static const char *const HTTP2_STAT_SESSION_DIE_ERROR_NAME        = "proxy.process.http2.session_die_error";
+static const char *const HTTP2_STAT_PUSH_PROMISES_NAME            = "proxy.process.http2.push_promises";
+static const char *const HTTP2_STAT_PUSH_SKIPPED_NAME             = "proxy.process.http2.push_skipped";
+static const char *const HTTP2_STAT_PUSH_CANCELLED_NAME           = "proxy.process.http2.push_cancelled";
+static const char *const HTTP2_STAT_PUSH_REFUSED_NAME             = "proxy.process.http2.push_refused";
+static const char *const HTTP2_STAT_RECV_WINDOW_GROWN_NAME        = "proxy.process.http2.receive_window_grown";
+static const char *const HTTP2_STAT_RECV_WINDOW_STALL_NAME        = "proxy.process.http2.receive_window_stalls";
+static const char *const HTTP2_STAT_SEND_WINDOW_STALL_NAME        = "proxy.process.http2.send_window_stalls";
+static const char *const HTTP2_STAT_DISTRIBUTED_TRANSACTIONS_NAME = "proxy.process.http2.distributed_transactions";
 
 union byte_pointer {
   byte_pointer(void *p) : ptr(p) {}
@@ -541,13 +549,22 @@ http2_generate_h2_header_from_1_1(HTTPHdr *headers, HTTPHdr *h2_headers)
     field->value_set(h2_headers->m_heap, h2_headers->m_mime, value, value_len);
     h2_headers->field_attach(field);
 
-    // Add ':path' header field
-    field      = h2_headers->field_create(HTTP2_VALUE_PATH, HTTP2_LEN_PATH);
-    value      = headers->path_get(&value_len);
-    char *path = (char *)ats_malloc(value_len + 1);
-    path[0]    = '/';
-    memcpy(path + 1, value, value_len);
-    field->value_set(h2_headers->m_heap, h2_headers->m_mime, path, value_len + 1);
+    // Add ':path' header field, the query is part of it
+    int query_len;
+    const char *query = headers->url_get()->query_get(&query_len);
+    field             = h2_headers->field_create(HTTP2_VALUE_PATH, HTTP2_LEN_PATH);
+    value             = headers->path_get(&value_len);
+    char *path        = (char *)ats_malloc(value_len + query_len + 2);
+    int path_len      = 0;
+    path[path_len++]  = '/';
+    memcpy(path + path_len, value, value_len);
+    path_len += value_len;
+    if (query_len > 0) {
+      path[path_len++] = '?';
+      memcpy(path + path_len, query, query_len);
+      path_len += query_len;
+    }
+    field->value_set(h2_headers->m_heap, h2_headers->m_mime, path, path_len);
     ats_free(path);
     h2_headers->field_attach(field);
 
@@ -574,6 +591,19 @@ http2_generate_h2_header_from_1_1(HTTPHdr *headers, HTTPHdr *h2_headers)
         (name_len == MIME_LEN_UPGRADE && strncasecmp(name, MIME_FIELD_UPGRADE, name_len) == 0)) {
       continue;
     }
+    if (http_hdr_type_get(headers->m_http) == HTTP_TYPE_REQUEST) {
+      // A request carries the host in ':authority' ([RFC 7540] 8.1.2.3.) and TE may only ask for trailers
+      // ([RFC 7540] 8.1.2.2.).
+      if (name_len == MIME_LEN_HOST && strncasecmp(name, MIME_FIELD_HOST, name_len) == 0) {
+        continue;
+      }
+      if (name_len == MIME_LEN_TE && strncasecmp(name, MIME_FIELD_TE, name_len) == 0) {
+        value = field->value_get(&value_len);
+        if (!(value_len == 8 && strncasecmp(value, "trailers", 8) == 0)) {
+          continue;
+        }
+      }
+    }
     MIMEField *newfield;
     name     = field->name_get(&name_len);
     newfield = h2_headers->field_create(name, name_len);
@@ -583,6 +613,52 @@ http2_generate_h2_header_from_1_1(HTTPHdr *headers, HTTPHdr *h2_headers)
   }
 }
 
+/**
+ * [RFC 9218] 4. The Priority HTTP Header Field, a structured field dictionary. Only the urgency
+ * "u" and the incremental "i" members are used, members of other types or out of range values are
+ * ignored and leave @a urgency and @a incremental as they are. Parameters are dropped.
+ */
+void
+http2_parse_priority_field(const char *value, int len, uint8_t &urgency, bool &incremental)
+{
+  const char *end = value + len;
+
+  while (value < end) {
+    while (value < end && (*value == ' ' || *value == '\t' || *value == ',')) {
+      ++value;
+    }
+    const char *key = value;
+    while (value < end && *value != '=' && *value != ';' && *value != ',') {
+      ++value;
+    }
+    int key_len      = value - key;
+    const char *item = nullptr;
+    int item_len     = 0;
+    if (value < end && *value == '=') {
+      item = ++value;
+      while (value < end && *value != ';' && *value != ',') {
+        ++value;
+      }
+      item_len = value - item;
+    }
+    while (value < end && *value != ',') {
+      ++value;
+    }
+
+    if (key_len == 1 && key[0] == 'u') {
+      if (item_len == 1 && item[0] >= '0' && item[0] <= '0' + HTTP2_PRIORITY_URGENCY_MAX) {
+        urgency = item[0] - '0';
+      }
+    } else if (key_len == 1 && key[0] == 'i') {
+      if (item == nullptr || (item_len == 2 && memcmp(item, "?1", 2) == 0)) {
+        incremental = true;
+      } else if (item_len == 2 && memcmp(item, "?0", 2) == 0) {
+        incremental = false;
+      }
+    }
+  }
+}
+
 Http2ErrorCode
 http2_encode_header_blocks(HTTPHdr *in, uint8_t *out, uint32_t out_len, uint32_t *len_written, HpackHandle &handle,
                            int32_t maximum_table_size)
@@ -720,6 +796,8 @@ uint32_t Http2::max_active_streams_in      = 0;
 bool Http2::throttling                     = false;
 uint32_t Http2::stream_priority_enabled    = 0;
 uint32_t Http2::initial_window_size        = 1048576;
+uint32_t Http2::max_window_size            = 16777216;
+int64_t Http2::max_window_memory           = 268435456;
 uint32_t Http2::max_frame_size             = 16384;
 uint32_t Http2::header_table_size          = 4096;
 uint32_t Http2::max_header_list_size       = 4294967295;
@@ -728,6 +806,8 @@ uint32_t Http2::accept_no_activity_timeout = 120;
 uint32_t Http2::no_activity_timeout_in     = 120;
 uint32_t Http2::active_timeout_in          = 0;
 uint32_t Http2::push_diary_size            = 256;
+uint32_t Http2::push_cached_only           = 0;
+uint32_t Http2::distribute_transactions    = 0;
 
 void
 Http2::init()
@@ -737,6 +817,8 @@ Http2::init()
   REC_EstablishStaticConfigInt32U(max_active_streams_in, "proxy.config.http2.max_active_streams_in");
   REC_EstablishStaticConfigInt32U(stream_priority_enabled, "proxy.config.http2.stream_priority_enabled");
   REC_EstablishStaticConfigInt32U(initial_window_size, "proxy.config.http2.initial_window_size_in");
+  REC_EstablishStaticConfigInt32U(max_window_size, "proxy.config.http2.max_window_size_in");
+  REC_EstablishStaticConfigInteger(max_window_memory, "proxy.config.http2.max_window_memory");
   REC_EstablishStaticConfigInt32U(max_frame_size, "proxy.config.http2.max_frame_size");
   REC_EstablishStaticConfigInt32U(header_table_size, "proxy.config.http2.header_table_size");
   REC_EstablishStaticConfigInt32U(max_header_list_size, "proxy.config.http2.max_header_list_size");
@@ -745,6 +827,8 @@ Http2::init()
   REC_EstablishStaticConfigInt32U(no_activity_timeout_in, "proxy.config.http2.no_activity_timeout_in");
   REC_EstablishStaticConfigInt32U(active_timeout_in, "proxy.config.http2.active_timeout_in");
   REC_EstablishStaticConfigInt32U(push_diary_size, "proxy.config.http2.push_diary_size");
+  REC_EstablishStaticConfigInt32U(push_cached_only, "proxy.config.http2.push_cached_only");
+  REC_EstablishStaticConfigInt32U(distribute_transactions, "proxy.config.http2.distribute_transactions");
 
   // If any settings is broken, ATS should not start
   ink_release_assert(http2_settings_parameter_is_valid({HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, max_concurrent_streams_in}));
@@ -790,6 +874,22 @@ Http2::init()
                      static_cast<int>(HTTP2_STAT_SESSION_DIE_INACTIVE), RecRawStatSyncSum);
   RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_SESSION_DIE_ERROR_NAME, RECD_INT, RECP_PERSISTENT,
                      static_cast<int>(HTTP2_STAT_SESSION_DIE_ERROR), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_PUSH_PROMISES_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_PUSH_PROMISES_COUNT), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_PUSH_SKIPPED_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_PUSH_SKIPPED_COUNT), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_PUSH_CANCELLED_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_PUSH_CANCELLED_COUNT), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_PUSH_REFUSED_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_PUSH_REFUSED_COUNT), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_RECV_WINDOW_GROWN_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_RECV_WINDOW_GROWN_COUNT), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_RECV_WINDOW_STALL_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_RECV_WINDOW_STALL_COUNT), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_SEND_WINDOW_STALL_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_SEND_WINDOW_STALL_COUNT), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_DISTRIBUTED_TRANSACTIONS_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_DISTRIBUTED_TRANSACTIONS_COUNT), RecRawStatSyncSum);
 }
 
 #if TS_HAS_TESTS
@@ -930,4 +1030,90 @@ REGRESSION_TEST(HTTP2_FRAME_FLAGS)(RegressionTest *t, int, int *pstatus)
   }
 }
 
+// An HTTP/1.1 request converted for HTTP/2, HPACK encoded and decoded on the other side, then converted back, as a pushed
+// request is.
+static bool
+http2_round_trip_header(HTTPHdr *in, HTTPHdr *out, HpackHandle &encoder, HpackHandle &decoder)
+{
+  HTTPHdr h2_hdr;
+  uint8_t buf[1024];
+  uint32_t len = 0;
+  bool trailer = false;
+
+  http2_generate_h2_header_from_1_1(in, &h2_hdr);
+  Http2ErrorCode err = http2_encode_header_blocks(&h2_hdr, buf, sizeof(buf), &len, encoder, Http2::header_table_size);
+  h2_hdr.destroy();
+  if (err != Http2ErrorCode::HTTP2_ERROR_NO_ERROR) {
+    return false;
+  }
+
+  out->create(HTTP_TYPE_REQUEST);
+  if (http2_decode_header_blocks(out, buf, len, nullptr, decoder, trailer, Http2::header_table_size) !=
+      Http2ErrorCode::HTTP2_ERROR_NO_ERROR) {
+    return false;
+  }
+  return http2_convert_header_from_2_to_1_1(out) == PARSE_RESULT_DONE;
+}
+
+REGRESSION_TEST(HTTP2_HEADER_ROUND_TRIP)(RegressionTest *t, int, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  HpackHandle client_encoder(Http2::header_table_size), server_decoder(Http2::header_table_size);
+  HTTPParser parser;
+  HTTPHdr req, out;
+  const char *value;
+  int len;
+
+  const char req_str[] = "GET /a/b.html?x=1&y=2 HTTP/1.1\r\n"
+                         "Host: origin.example.com:8080\r\n"
+                         "Connection: keep-alive\r\n"
+                         "TE: gzip\r\n"
+                         "Accept: */*\r\n"
+                         "\r\n";
+  const char *start = req_str;
+  http_parser_init(&parser);
+  req.create(HTTP_TYPE_REQUEST);
+  req.parse_req(&parser, &start, req_str + sizeof(req_str) - 1, true);
+  http_parser_clear(&parser);
+
+  box.check(http2_round_trip_header(&req, &out, client_encoder, server_decoder), "request should round trip");
+  value = out.path_get(&len);
+  box.check(len == 8 && memcmp(value, "a/b.html", len) == 0, "path is '%.*s'", len, value);
+  value = out.url_get()->query_get(&len);
+  box.check(len == 7 && memcmp(value, "x=1&y=2", len) == 0, "query is '%.*s'", len, value);
+  value = out.host_get(&len);
+  box.check(len == 18 && memcmp(value, "origin.example.com", len) == 0, "host is '%.*s'", len, value);
+  box.check(out.port_get() == 8080, "port is %d", out.port_get());
+  box.check(out.field_find(MIME_FIELD_CONNECTION, MIME_LEN_CONNECTION) == nullptr, "Connection should be dropped");
+  box.check(out.field_find(MIME_FIELD_TE, MIME_LEN_TE) == nullptr, "TE other than trailers should be dropped");
+  box.check(out.field_find(MIME_FIELD_ACCEPT, MIME_LEN_ACCEPT) != nullptr, "Accept should be kept");
+  out.destroy();
+  req.destroy();
+}
+
+REGRESSION_TEST(HTTP2_PRIORITY_FIELD)(RegressionTest *t, int, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  static const struct {
+    const char *value;
+    uint8_t urgency;
+    bool incremental;
+  } cases[] = {
+    {"", 3, false},           {"u=0", 0, false},         {"u=7, i", 7, true},         {"i=?1,u=1", 1, true},
+    {"i=?0", 3, false},       {"u=8", 3, false},         {"u=12", 3, false},          {"u=\"1\"", 3, false},
+    {"i=1", 3, false},        {"u=2;x=y, i;z", 2, true}, {"foo=bar, u=5", 5, false},  {"uu=1, ii", 3, false},
+  };
+
+  for (auto &c : cases) {
+    uint8_t urgency  = HTTP2_PRIORITY_URGENCY_DEFAULT;
+    bool incremental = HTTP2_PRIORITY_INCREMENTAL_DEFAULT;
+    http2_parse_priority_field(c.value, strlen(c.value), urgency, incremental);
+    box.check(urgency == c.urgency && incremental == c.incremental, "'%s' parsed as u=%u i=%d", c.value, urgency, incremental);
+  }
+}
+
 #endif /* TS_HAS_TESTS */
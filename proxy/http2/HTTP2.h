@@ -69,6 +69,18 @@ const uint32_t HTTP2_MAX_HEADER_LIST_SIZE   = UINT_MAX;
 const uint32_t HTTP2_PRIORITY_DEFAULT_STREAM_DEPENDENCY = 0;
 const uint8_t HTTP2_PRIORITY_DEFAULT_WEIGHT             = 15;
 
+// [RFC 9218] 4.1 Urgency and 4.2 Incremental
+const uint8_t HTTP2_PRIORITY_URGENCY_DEFAULT  = 3;
+const uint8_t HTTP2_PRIORITY_URGENCY_MAX      = 7;
+const bool HTTP2_PRIORITY_INCREMENTAL_DEFAULT = false;
+
+// Values of proxy.config.http2.stream_priority_enabled
+enum Http2StreamPriorityMode {
+  HTTP2_STREAM_PRIORITY_DISABLED   = 0,
+  HTTP2_STREAM_PRIORITY_DEPENDENCY = 1, // [RFC 7540] 5.3 Stream Priority
+  HTTP2_STREAM_PRIORITY_EXTENSIBLE = 2, // [RFC 9218] Extensible Prioritization Scheme
+};
+
 // Statistics
 enum {
   HTTP2_STAT_CURRENT_CLIENT_SESSION_COUNT, // Current # of active HTTP2
@@ -85,6 +97,14 @@ enum {
   HTTP2_STAT_SESSION_DIE_INACTIVE,
   HTTP2_STAT_SESSION_DIE_EOS,
   HTTP2_STAT_SESSION_DIE_ERROR,
+  HTTP2_STAT_PUSH_PROMISES_COUNT,            // Streams pushed
+  HTTP2_STAT_PUSH_SKIPPED_COUNT,             // Pushes not made, the client holds the URL
+  HTTP2_STAT_PUSH_CANCELLED_COUNT,           // Pushed streams reset, the response was not a cached 200
+  HTTP2_STAT_PUSH_REFUSED_COUNT,             // Pushed streams the client reset
+  HTTP2_STAT_RECV_WINDOW_GROWN_COUNT,        // Receive windows doubled by auto-tuning
+  HTTP2_STAT_RECV_WINDOW_STALL_COUNT,        // Receive windows that limited the client but could not grow
+  HTTP2_STAT_SEND_WINDOW_STALL_COUNT,        // DATA frames waiting for the client's window
+  HTTP2_STAT_DISTRIBUTED_TRANSACTIONS_COUNT, // Streams whose HttpSM ran on another thread
 
   HTTP2_N_STATS // Terminal counter, NOT A STAT INDEX.
 };
@@ -357,6 +377,8 @@ Http2ErrorCode http2_encode_header_blocks(HTTPHdr *, uint8_t *, uint32_t, uint32
 ParseResult http2_convert_header_from_2_to_1_1(HTTPHdr *);
 void http2_generate_h2_header_from_1_1(HTTPHdr *headers, HTTPHdr *h2_headers);
 
+void http2_parse_priority_field(const char *value, int len, uint8_t &urgency, bool &incremental);
+
 // Not sure where else to put this, but figure this is as good of a start as
 // anything else.
 // Right now, only the static init() is available, which sets up some basic
@@ -371,6 +393,8 @@ public:
   static bool throttling;
   static uint32_t stream_priority_enabled;
   static uint32_t initial_window_size;
+  static uint32_t max_window_size;
+  static int64_t max_window_memory;
   static uint32_t max_frame_size;
   static uint32_t header_table_size;
   static uint32_t max_header_list_size;
@@ -379,6 +403,8 @@ public:
   static uint32_t no_activity_timeout_in;
   static uint32_t active_timeout_in;
   static uint32_t push_diary_size;
+  static uint32_t push_cached_only;
+  static uint32_t distribute_transactions;
 
   static void init();
 };
@@ -76,9 +76,7 @@ Http2ClientSession::destroy()
 void
 Http2ClientSession::free()
 {
-  if (h2_pushed_urls) {
-    this->h2_pushed_urls = ink_hash_table_destroy(this->h2_pushed_urls);
-  }
+  push_diary.clear();
 
   if (client_vc) {
     release_netvc();
@@ -184,8 +182,7 @@ Http2ClientSession::new_connection(NetVConnection *new_vc, MIOBuffer *iobuf, IOB
   this->read_buffer             = iobuf ? iobuf : new_MIOBuffer(HTTP2_HEADER_BUFFER_SIZE_INDEX);
   this->read_buffer->water_mark = connection_state.server_settings.get(HTTP2_SETTINGS_MAX_FRAME_SIZE);
   this->sm_reader               = reader ? reader : this->read_buffer->alloc_reader();
-  this->h2_pushed_urls          = ink_hash_table_create(InkHashTableKeyType_String);
-  this->h2_pushed_urls_size     = 0;
+  this->push_diary.init(Http2::push_diary_size);
 
   this->write_buffer = new_MIOBuffer(HTTP2_HEADER_BUFFER_SIZE_INDEX);
   this->sm_writer    = this->write_buffer->alloc_reader();
@@ -269,8 +266,15 @@ Http2ClientSession::do_io_close(int alerrno)
     cached_client_addr.assign(client_vc->get_remote_addr());
     cached_local_addr.assign(client_vc->get_local_addr());
     this->release_netvc();
-    client_vc->do_io_close();
-    client_vc = nullptr;
+    if (connection_state.get_distributed_stream_count() > 0) {
+      // Transactions on other threads may still look at the netvc, it is closed by free() once they are done
+      client_vc->cancel_inactivity_timeout();
+      client_vc->cancel_active_timeout();
+      client_vc->do_io_shutdown(IO_SHUTDOWN_READWRITE);
+    } else {
+      client_vc->do_io_close();
+      client_vc = nullptr;
+    }
   }
   this->connection_state.release_stream(nullptr);
 }
@@ -28,6 +28,7 @@
 #include "Plugin.h"
 #include "ProxyClientSession.h"
 #include "Http2ConnectionState.h"
+#include "Http2PushDiary.h"
 #include <ts/string_view.h>
 #include <ts/ink_inet.h>
 
@@ -91,12 +92,14 @@ public:
     return this->hdr;
   }
 
-  // Allocate an IOBufferBlock for payload of this frame.
+  // Allocate an IOBufferBlock for payload of this frame. The frame header is reserved at its start so
+  // the whole frame goes out in one piece.
   void
   alloc(int index)
   {
     this->ioblock = new_IOBufferBlock();
     this->ioblock->alloc(index);
+    this->ioblock->fill(HTTP2_FRAME_HEADER_LEN);
   }
 
   // Return the writeable buffer space for frame payload
@@ -114,21 +117,27 @@ public:
       ink_assert((int64_t)nbytes <= this->ioblock->write_avail());
       this->ioblock->fill(nbytes);
 
-      this->hdr.length = this->ioblock->size();
+      this->hdr.length = this->ioblock->size() - HTTP2_FRAME_HEADER_LEN;
     }
   }
 
+  // Frames that fit in a block of the session write buffer are copied into it, so the small frames
+  // sent in one event loop pass share TLS records and writes. Bigger frames are appended as is.
   void
   xmit(MIOBuffer *iobuffer)
   {
-    // Write frame header
-    uint8_t buf[HTTP2_FRAME_HEADER_LEN];
-    http2_write_frame_header(hdr, make_iovec(buf));
-    iobuffer->write(buf, sizeof(buf));
-
-    // Write frame payload
-    // It could be empty (e.g. SETTINGS frame with ACK flag)
-    if (ioblock && ioblock->read_avail() > 0) {
+    if (!ioblock) {
+      uint8_t buf[HTTP2_FRAME_HEADER_LEN];
+      http2_write_frame_header(hdr, make_iovec(buf));
+      iobuffer->write(buf, sizeof(buf));
+      return;
+    }
+
+    http2_write_frame_header(hdr, make_iovec(ioblock->start(), HTTP2_FRAME_HEADER_LEN));
+    int64_t len = ioblock->read_avail();
+    if (len <= iobuffer->block_write_avail() || len <= BUFFER_SIZE_FOR_INDEX(HTTP2_HEADER_BUFFER_SIZE_INDEX)) {
+      iobuffer->write(ioblock->start(), len);
+    } else {
       iobuffer->append_block(this->ioblock.get());
     }
   }
@@ -137,7 +146,7 @@ public:
   size()
   {
     if (ioblock) {
-      return HTTP2_FRAME_HEADER_LEN + ioblock->size();
+      return ioblock->size();
     } else {
       return HTTP2_FRAME_HEADER_LEN;
     }
@@ -295,21 +304,13 @@ public:
   bool
   is_url_pushed(const char *url, int url_len)
   {
-    char *dup_url            = ats_strndup(url, url_len);
-    InkHashTableEntry *entry = ink_hash_table_lookup_entry(h2_pushed_urls, dup_url);
-    ats_free(dup_url);
-    return entry != nullptr;
+    return push_diary.contains(url, url_len);
   }
 
   void
   add_url_to_pushed_table(const char *url, int url_len)
   {
-    if (h2_pushed_urls_size < Http2::push_diary_size) {
-      char *dup_url = ats_strndup(url, url_len);
-      ink_hash_table_insert(h2_pushed_urls, dup_url, nullptr);
-      h2_pushed_urls_size++;
-      ats_free(dup_url);
-    }
+    push_diary.add(url, url_len);
   }
 
   // noncopyable
@@ -350,8 +351,8 @@ private:
   bool half_close_local = false;
   int recursion         = 0;
 
-  InkHashTable *h2_pushed_urls = nullptr;
-  uint32_t h2_pushed_urls_size = 0;
+  // URLs pushed to or requested by the client
+  Http2PushDiary push_diary;
 };
 
 extern ClassAllocator<Http2ClientSession> http2ClientSessionAllocator;
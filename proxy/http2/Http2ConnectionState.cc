@@ -27,6 +27,8 @@
 #include "Http2Stream.h"
 #include "Http2DebugNames.h"
 
+#include <atomic>
+
 #define DebugHttp2Con(ua_session, fmt, ...) \
   DebugSsn(ua_session, "http2_con", "[%" PRId64 "] " fmt, ua_session->connection_id(), ##__VA_ARGS__);
 
@@ -48,6 +50,13 @@ static const int buffer_size_index[HTTP2_FRAME_TYPE_MAX] = {
   BUFFER_SIZE_INDEX_16K, // HTTP2_FRAME_TYPE_CONTINUATION
 };
 
+// Room for the payload of a frame sent, its header takes the start of the block.
+inline static size_t
+frame_payload_size(Http2FrameType type)
+{
+  return BUFFER_SIZE_FOR_INDEX(buffer_size_index[type]) - HTTP2_FRAME_HEADER_LEN;
+}
+
 inline static unsigned
 read_rcv_buffer(char *buf, size_t bufsize, unsigned &nbytes, const Http2Frame &frame)
 {
@@ -166,22 +175,31 @@ rcv_data_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
   }
   myreader->writer()->dealloc_reader(myreader);
 
-  uint32_t initial_rwnd = cstate.server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE);
-  uint32_t min_rwnd     = std::min(initial_rwnd, cstate.server_settings.get(HTTP2_SETTINGS_MAX_FRAME_SIZE));
-  // Connection level WINDOW UPDATE
-  if (cstate.server_rwnd <= min_rwnd) {
-    Http2WindowSize diff_size = initial_rwnd - cstate.server_rwnd;
-    cstate.server_rwnd += diff_size;
-    cstate.send_window_update_frame(0, diff_size);
+  cstate.refill_server_rwnd(stream);
+
+  return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
+}
+
+// [RFC 9218] 5. The Priority header field of a request sets its urgency and incremental parameters.
+static void
+apply_priority_field(Http2ConnectionState &cstate, Http2Stream *stream)
+{
+  if (stream->priority_node == nullptr || !cstate.dependency_tree->is_extensible()) {
+    return;
   }
-  // Stream level WINDOW UPDATE
-  if (stream->server_rwnd <= min_rwnd) {
-    Http2WindowSize diff_size = initial_rwnd - stream->server_rwnd;
-    stream->server_rwnd += diff_size;
-    cstate.send_window_update_frame(stream->get_id(), diff_size);
+
+  MIMEField *field = stream->get_request_header()->field_find("priority", 8);
+  if (field == nullptr) {
+    return;
   }
 
-  return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
+  int len;
+  const char *value = field->value_get(&len);
+  uint8_t urgency   = HTTP2_PRIORITY_URGENCY_DEFAULT;
+  bool incremental  = HTTP2_PRIORITY_INCREMENTAL_DEFAULT;
+  http2_parse_priority_field(value, len, urgency, incremental);
+  DebugHttp2Stream(cstate.ua_session, stream->get_id(), "PRIORITY - urgency: %u, incremental: %d", urgency, incremental);
+  cstate.dependency_tree->set_urgency(stream->priority_node, urgency, incremental);
 }
 
 /*
@@ -278,7 +296,11 @@ rcv_headers_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
     header_block_fragment_length -= HTTP2_PRIORITY_LEN;
   }
 
-  if (new_stream && Http2::stream_priority_enabled) {
+  if (new_stream && Http2::stream_priority_enabled && cstate.dependency_tree->is_extensible()) {
+    // Extensible priorities come with the request header, the stream starts with the defaults.
+    stream->priority_node =
+      cstate.dependency_tree->add(stream_id, HTTP2_PRIORITY_URGENCY_DEFAULT, HTTP2_PRIORITY_INCREMENTAL_DEFAULT, stream);
+  } else if (new_stream && Http2::stream_priority_enabled) {
     Http2DependencyTree::Node *node = cstate.dependency_tree->find(stream_id);
     if (node != nullptr) {
       stream->priority_node = node;
@@ -336,6 +358,7 @@ rcv_headers_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
 
     // Set up the State Machine
     if (!empty_request) {
+      apply_priority_field(cstate, stream);
       stream->new_transaction();
       // Send request header to SM
       stream->send_request(cstate);
@@ -376,7 +399,8 @@ rcv_priority_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
                       "priority bad length");
   }
 
-  if (!Http2::stream_priority_enabled) {
+  // [RFC 9218] 2.1 Endpoints using extensible priorities ignore the RFC 7540 signals.
+  if (!Http2::stream_priority_enabled || cstate.dependency_tree->is_extensible()) {
     return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
   }
 
@@ -470,6 +494,10 @@ rcv_rst_stream_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
   if (stream != nullptr) {
     DebugHttp2Stream(cstate.ua_session, stream_id, "RST_STREAM: Error Code: %u", rst_stream.error_code);
 
+    if (!http2_is_client_streamid(stream_id)) {
+      HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_PUSH_REFUSED_COUNT, this_ethread());
+    }
+
     cstate.delete_stream(stream);
   }
 
@@ -587,13 +615,14 @@ rcv_ping_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
                       "ping bad length");
   }
 
+  frame.reader()->memcpy(opaque_data, HTTP2_PING_LEN, 0);
+
   // An endpoint MUST NOT respond to PING frames containing this flag.
   if (frame.header().flags & HTTP2_FLAGS_PING_ACK) {
+    cstate.receive_ping_ack(opaque_data);
     return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
   }
 
-  frame.reader()->memcpy(opaque_data, HTTP2_PING_LEN, 0);
-
   // ACK (0x1): An endpoint MUST set this flag in PING responses.
   cstate.send_ping_frame(stream_id, HTTP2_FLAGS_PING_ACK, opaque_data);
 
@@ -809,6 +838,7 @@ rcv_continuation_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
     }
 
     // Set up the State Machine
+    apply_priority_field(cstate, stream);
     stream->new_transaction();
     // Send request header to SM
     stream->send_request(cstate);
@@ -860,6 +890,12 @@ Http2ConnectionState::main_event_handler(int event, void *edata)
     if (server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE) > HTTP2_INITIAL_WINDOW_SIZE) {
       send_window_update_frame(0, server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE) - HTTP2_INITIAL_WINDOW_SIZE);
     }
+    server_rwnd        = std::max(server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE), HTTP2_INITIAL_WINDOW_SIZE);
+    server_rwnd_target = server_rwnd;
+    _rwnd_refilled_at  = Thread::get_hrtime();
+    if (Http2::max_window_size > server_rwnd_target) {
+      _send_rtt_ping();
+    }
 
     break;
   }
@@ -1025,11 +1061,13 @@ Http2ConnectionState::create_stream(Http2StreamId new_id, Http2Error &error)
 
   Http2Stream *new_stream = THREAD_ALLOC_INIT(http2StreamAllocator, this_ethread());
   new_stream->init(new_id, client_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE));
+  new_stream->server_rwnd = server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE);
 
   ink_assert(nullptr != new_stream);
   ink_assert(!stream_list.in(new_stream));
 
   stream_list.enqueue(new_stream);
+  stream_map.insert(new_id, new_stream);
   if (client_streamid) {
     latest_streamid_in = new_id;
     ink_assert(client_streams_in_count < UINT32_MAX);
@@ -1055,13 +1093,7 @@ Http2ConnectionState::create_stream(Http2StreamId new_id, Http2Error &error)
 Http2Stream *
 Http2ConnectionState::find_stream(Http2StreamId id) const
 {
-  for (Http2Stream *s = stream_list.head; s; s = static_cast<Http2Stream *>(s->link.next)) {
-    if (s->get_id() == id) {
-      return s;
-    }
-    ink_assert(s != s->link.next);
-  }
-  return nullptr;
+  return stream_map.find(id);
 }
 
 void
@@ -1092,6 +1124,7 @@ Http2ConnectionState::cleanup_streams()
   }
 
   ink_assert(stream_list.empty());
+  ink_assert(stream_map.size() == 0);
 
   if (!is_state_closed()) {
     SCOPED_MUTEX_LOCK(lock, this->ua_session->mutex, this_ethread());
@@ -1127,7 +1160,14 @@ Http2ConnectionState::delete_stream(Http2Stream *stream)
     send_rst_stream_frame(stream->get_id(), Http2ErrorCode::HTTP2_ERROR_NO_ERROR);
   }
 
+  // A transaction running on another thread outlives the stream it answered, the client may reuse its slot right away
+  if (stream->is_sm_distributed() && http2_is_client_streamid(stream->get_id())) {
+    ink_assert(client_streams_in_count > 0);
+    --client_streams_in_count;
+  }
+
   stream_list.remove(stream);
+  stream_map.remove(stream->get_id());
   stream->initiating_close();
 
   return true;
@@ -1140,13 +1180,21 @@ Http2ConnectionState::release_stream(Http2Stream *stream)
   if (stream) {
     --total_client_streams_count;
     if (http2_is_client_streamid(stream->get_id())) {
-      ink_assert(client_streams_in_count > 0);
-      --client_streams_in_count;
+      // delete_stream already gave back the slot of a distributed stream
+      if (!stream->is_sm_distributed() || stream_list.in(stream)) {
+        ink_assert(client_streams_in_count > 0);
+        --client_streams_in_count;
+      }
     } else {
       ink_assert(client_streams_out_count > 0);
       --client_streams_out_count;
     }
+    if (stream->is_sm_distributed()) {
+      ink_assert(distributed_streams_count > 0);
+      --distributed_streams_count;
+    }
     stream_list.remove(stream);
+    stream_map.remove(stream->get_id());
   }
 
   if (ua_session) {
@@ -1213,7 +1261,7 @@ Http2ConnectionState::send_data_frames_depends_on_priority()
 
   Http2Stream *stream = static_cast<Http2Stream *>(node->t);
   ink_release_assert(stream != nullptr);
-  DebugHttp2Stream(ua_session, stream->get_id(), "top node, point=%d", node->point);
+  DebugHttp2Stream(ua_session, stream->get_id(), "top node, point=%" PRIu64, node->point);
 
   size_t len                       = 0;
   Http2SendADataFrameResult result = send_a_data_frame(stream, len);
@@ -1243,20 +1291,109 @@ Http2ConnectionState::send_data_frames_depends_on_priority()
   return;
 }
 
+// Receive window growth of all connections, bounded by Http2::max_window_memory
+static std::atomic<int64_t> server_rwnd_growth(0);
+
+/**
+ * Receive window auto-tuning, the windows are topped up once half of them is used. A client that used
+ * the half in less than a round trip is limited by the window, the window is below twice the
+ * bandwidth-delay product and the connection window is doubled. Stream windows follow it.
+ */
+void
+Http2ConnectionState::refill_server_rwnd(Http2Stream *stream)
+{
+  // Connection level WINDOW UPDATE
+  if (server_rwnd <= server_rwnd_target / 2) {
+    ink_hrtime now = Thread::get_hrtime();
+    if (_rtt > 0 && now - _rwnd_refilled_at < _rtt) {
+      _grow_server_rwnd();
+    }
+    Http2WindowSize diff_size = server_rwnd_target - server_rwnd;
+    server_rwnd += diff_size;
+    _rwnd_refilled_at = now;
+    send_window_update_frame(0, diff_size);
+  }
+  // Stream level WINDOW UPDATE
+  if (stream->server_rwnd <= server_rwnd_target / 2) {
+    Http2WindowSize diff_size = server_rwnd_target - stream->server_rwnd;
+    stream->server_rwnd += diff_size;
+    send_window_update_frame(stream->get_id(), diff_size);
+  }
+}
+
+void
+Http2ConnectionState::_grow_server_rwnd()
+{
+  const ssize_t max_rwnd = std::min(static_cast<ssize_t>(Http2::max_window_size), static_cast<ssize_t>(HTTP2_MAX_WINDOW_SIZE));
+  const ssize_t growth   = std::min(server_rwnd_target, max_rwnd - server_rwnd_target);
+
+  if (growth <= 0) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_RECV_WINDOW_STALL_COUNT, this_ethread());
+    return;
+  }
+  if (server_rwnd_growth.fetch_add(growth) + growth > Http2::max_window_memory) {
+    server_rwnd_growth.fetch_sub(growth);
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_RECV_WINDOW_STALL_COUNT, this_ethread());
+    return;
+  }
+
+  server_rwnd_target += growth;
+  _rwnd_growth += growth;
+  HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_RECV_WINDOW_GROWN_COUNT, this_ethread());
+  DebugHttp2Con(ua_session, "Receive window grown to %zd, rtt %" PRId64 " us", server_rwnd_target, ink_hrtime_to_usec(_rtt));
+
+  // The round trip time may have changed with the load on the link
+  _send_rtt_ping();
+}
+
+void
+Http2ConnectionState::release_server_rwnd()
+{
+  server_rwnd_growth.fetch_sub(_rwnd_growth);
+  _rwnd_growth = 0;
+}
+
+void
+Http2ConnectionState::_send_rtt_ping()
+{
+  if (_ping_sent_at != 0) {
+    return;
+  }
+
+  uint8_t opaque_data[HTTP2_PING_LEN];
+  _ping_sent_at = Thread::get_hrtime();
+  memcpy(opaque_data, &_ping_sent_at, sizeof(opaque_data));
+  send_ping_frame(0, 0, opaque_data);
+}
+
+void
+Http2ConnectionState::receive_ping_ack(const uint8_t *opaque_data)
+{
+  if (_ping_sent_at != 0 && memcmp(opaque_data, &_ping_sent_at, HTTP2_PING_LEN) == 0) {
+    _rtt          = Thread::get_hrtime() - _ping_sent_at;
+    _ping_sent_at = 0;
+  }
+}
+
 Http2SendADataFrameResult
 Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_length)
 {
+  // The frame header shares the payload block, a full frame then fills exactly one TLS record.
   const ssize_t window_size         = std::min(this->client_rwnd, stream->client_rwnd);
-  const size_t buf_len              = BUFFER_SIZE_FOR_INDEX(buffer_size_index[HTTP2_FRAME_TYPE_DATA]);
+  const size_t buf_len              = frame_payload_size(HTTP2_FRAME_TYPE_DATA);
   const size_t write_available_size = std::min(buf_len, static_cast<size_t>(window_size));
   size_t read_available_size        = 0;
 
-  uint8_t flags = 0x00;
-  uint8_t payload_buffer[buf_len];
+  uint8_t flags                  = 0x00;
   IOBufferReader *current_reader = stream->response_get_data_reader();
 
   SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
 
+  // Until the HEADERS frame is out the buffer holds the response header, not body
+  if (!stream->response_header_done) {
+    return HTTP2_SEND_A_DATA_FRAME_NO_PAYLOAD;
+  }
+
   if (current_reader) {
     read_available_size = static_cast<size_t>(current_reader->read_avail());
   }
@@ -1265,10 +1402,10 @@ Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_len
   if (read_available_size > 0) {
     // We only need to check for window size when there is a payload
     if (window_size <= 0) {
+      HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_SEND_WINDOW_STALL_COUNT, this_ethread());
       return HTTP2_SEND_A_DATA_FRAME_NO_WINDOW;
     }
-    // Copy into the payload buffer. Seems like we should be able to skip this copy step
-    payload_length = current_reader->read(payload_buffer, write_available_size);
+    payload_length = std::min(read_available_size, write_available_size);
   } else {
     payload_length = 0;
   }
@@ -1292,9 +1429,12 @@ Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_len
   DebugHttp2Stream(ua_session, stream->get_id(), "Send a DATA frame - client window con: %zd stream: %zd payload: %zd", client_rwnd,
                    stream->client_rwnd, payload_length);
 
+  // The payload is read straight into the frame
   Http2Frame data(HTTP2_FRAME_TYPE_DATA, stream->get_id(), flags);
   data.alloc(buffer_size_index[HTTP2_FRAME_TYPE_DATA]);
-  http2_write_data(payload_buffer, payload_length, data.write());
+  if (payload_length > 0) {
+    current_reader->read(data.write().iov_base, payload_length);
+  }
   data.finalize(payload_length);
 
   stream->update_sent_count(payload_length);
@@ -1379,7 +1519,7 @@ Http2ConnectionState::send_headers_frame(Http2Stream *stream)
   }
 
   // Send a HEADERS frame
-  if (header_blocks_size <= static_cast<uint32_t>(BUFFER_SIZE_FOR_INDEX(buffer_size_index[HTTP2_FRAME_TYPE_HEADERS]))) {
+  if (header_blocks_size <= static_cast<uint32_t>(frame_payload_size(HTTP2_FRAME_TYPE_HEADERS))) {
     payload_length = header_blocks_size;
     flags |= HTTP2_FLAGS_HEADERS_END_HEADERS;
     if (h2_hdr.presence(MIME_PRESENCE_CONTENT_LENGTH) && h2_hdr.get_content_length() == 0) {
@@ -1387,7 +1527,7 @@ Http2ConnectionState::send_headers_frame(Http2Stream *stream)
       stream->send_end_stream = true;
     }
   } else {
-    payload_length = BUFFER_SIZE_FOR_INDEX(buffer_size_index[HTTP2_FRAME_TYPE_HEADERS]);
+    payload_length = frame_payload_size(HTTP2_FRAME_TYPE_HEADERS);
   }
   Http2Frame headers(HTTP2_FRAME_TYPE_HEADERS, stream->get_id(), flags);
   headers.alloc(buffer_size_index[HTTP2_FRAME_TYPE_HEADERS]);
@@ -1414,7 +1554,7 @@ Http2ConnectionState::send_headers_frame(Http2Stream *stream)
   flags = 0;
   while (sent < header_blocks_size) {
     DebugHttp2Stream(ua_session, stream->get_id(), "Send CONTINUATION frame");
-    payload_length = std::min(static_cast<uint32_t>(BUFFER_SIZE_FOR_INDEX(buffer_size_index[HTTP2_FRAME_TYPE_CONTINUATION])),
+    payload_length = std::min(static_cast<uint32_t>(frame_payload_size(HTTP2_FRAME_TYPE_CONTINUATION)),
                               static_cast<uint32_t>(header_blocks_size - sent));
     if (sent + payload_length == header_blocks_size) {
       flags |= HTTP2_FLAGS_CONTINUATION_END_HEADERS;
@@ -1488,13 +1628,11 @@ Http2ConnectionState::send_push_promise_frame(Http2Stream *stream, URL &url, con
 
   // Send a PUSH_PROMISE frame
   Http2PushPromise push_promise;
-  if (header_blocks_size <=
-      BUFFER_SIZE_FOR_INDEX(buffer_size_index[HTTP2_FRAME_TYPE_PUSH_PROMISE]) - sizeof(push_promise.promised_streamid)) {
+  if (header_blocks_size <= frame_payload_size(HTTP2_FRAME_TYPE_PUSH_PROMISE) - sizeof(push_promise.promised_streamid)) {
     payload_length = header_blocks_size;
     flags |= HTTP2_FLAGS_PUSH_PROMISE_END_HEADERS;
   } else {
-    payload_length =
-      BUFFER_SIZE_FOR_INDEX(buffer_size_index[HTTP2_FRAME_TYPE_PUSH_PROMISE]) - sizeof(push_promise.promised_streamid);
+    payload_length = frame_payload_size(HTTP2_FRAME_TYPE_PUSH_PROMISE) - sizeof(push_promise.promised_streamid);
   }
   Http2Frame headers(HTTP2_FRAME_TYPE_PUSH_PROMISE, stream->get_id(), flags);
   headers.alloc(buffer_size_index[HTTP2_FRAME_TYPE_PUSH_PROMISE]);
@@ -1511,7 +1649,7 @@ Http2ConnectionState::send_push_promise_frame(Http2Stream *stream, URL &url, con
   flags = 0;
   while (sent < header_blocks_size) {
     DebugHttp2Stream(ua_session, stream->get_id(), "Send CONTINUATION frame");
-    payload_length = std::min(static_cast<uint32_t>(BUFFER_SIZE_FOR_INDEX(buffer_size_index[HTTP2_FRAME_TYPE_CONTINUATION])),
+    payload_length = std::min(static_cast<uint32_t>(frame_payload_size(HTTP2_FRAME_TYPE_CONTINUATION)),
                               static_cast<uint32_t>(header_blocks_size - sent));
     if (sent + payload_length == header_blocks_size) {
       flags |= HTTP2_FLAGS_CONTINUATION_END_HEADERS;
@@ -1533,7 +1671,10 @@ Http2ConnectionState::send_push_promise_frame(Http2Stream *stream, URL &url, con
     h2_hdr.destroy();
     return;
   }
-  if (Http2::stream_priority_enabled) {
+  if (Http2::stream_priority_enabled && this->dependency_tree->is_extensible()) {
+    stream->priority_node =
+      this->dependency_tree->add(id, HTTP2_PRIORITY_URGENCY_DEFAULT, HTTP2_PRIORITY_INCREMENTAL_DEFAULT, stream);
+  } else if (Http2::stream_priority_enabled) {
     Http2DependencyTree::Node *node = this->dependency_tree->find(id);
     if (node != nullptr) {
       stream->priority_node = node;
@@ -1547,6 +1688,11 @@ Http2ConnectionState::send_push_promise_frame(Http2Stream *stream, URL &url, con
     }
   }
   stream->change_state(HTTP2_FRAME_TYPE_PUSH_PROMISE, HTTP2_FLAGS_PUSH_PROMISE_END_HEADERS);
+  HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_PUSH_PROMISES_COUNT, this_ethread());
+  // The promise is what the client would request, only the request served here is limited to the cache
+  if (Http2::push_cached_only) {
+    h2_hdr.value_append(MIME_FIELD_CACHE_CONTROL, MIME_LEN_CACHE_CONTROL, HTTP_VALUE_ONLY_IF_CACHED, HTTP_LEN_ONLY_IF_CACHED, true);
+  }
   stream->set_request_headers(h2_hdr);
   stream->new_transaction();
   stream->send_request(*this);
@@ -1554,6 +1700,16 @@ Http2ConnectionState::send_push_promise_frame(Http2Stream *stream, URL &url, con
   h2_hdr.destroy();
 }
 
+void
+Http2ConnectionState::cancel_push(Http2Stream *stream)
+{
+  DebugHttp2Stream(ua_session, stream->get_id(), "Cancel push, response status %d", stream->response_header.status_get());
+  HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_PUSH_CANCELLED_COUNT, this_ethread());
+
+  send_rst_stream_frame(stream->get_id(), Http2ErrorCode::HTTP2_ERROR_CANCEL);
+  delete_stream(stream);
+}
+
 void
 Http2ConnectionState::send_rst_stream_frame(Http2StreamId id, Http2ErrorCode ec)
 {
@@ -28,6 +28,7 @@
 #include "HPACK.h"
 #include "Http2Stream.h"
 #include "Http2DependencyTree.h"
+#include "Http2StreamMap.h"
 
 class Http2ClientSession;
 
@@ -132,7 +133,8 @@ public:
     continued_buffer.iov_base = nullptr;
     continued_buffer.iov_len  = 0;
 
-    dependency_tree = new DependencyTree(Http2::max_concurrent_streams_in);
+    dependency_tree = new DependencyTree(Http2::max_concurrent_streams_in,
+                                         Http2::stream_priority_enabled == HTTP2_STREAM_PRIORITY_EXTENSIBLE);
   }
 
   void
@@ -147,6 +149,7 @@ public:
     ats_free(continued_buffer.iov_base);
 
     delete dependency_tree;
+    release_server_rwnd();
   }
 
   // Event handlers
@@ -163,6 +166,11 @@ public:
 
   void update_initial_rwnd(Http2WindowSize new_size);
 
+  // Receive window auto-tuning
+  void refill_server_rwnd(Http2Stream *stream);
+  void release_server_rwnd();
+  void receive_ping_ack(const uint8_t *opaque_data);
+
   Http2StreamId
   get_latest_stream_id_in() const
   {
@@ -210,9 +218,22 @@ public:
     return client_streams_in_count;
   }
 
+  // Streams whose transaction runs on another thread, the session keeps its netvc until they are gone
+  void
+  add_distributed_stream()
+  {
+    ++distributed_streams_count;
+  }
+  uint32_t
+  get_distributed_stream_count() const
+  {
+    return distributed_streams_count;
+  }
+
   // Connection level window size
-  ssize_t client_rwnd = HTTP2_INITIAL_WINDOW_SIZE;
-  ssize_t server_rwnd = Http2::initial_window_size;
+  ssize_t client_rwnd        = HTTP2_INITIAL_WINDOW_SIZE;
+  ssize_t server_rwnd        = Http2::initial_window_size;
+  ssize_t server_rwnd_target = Http2::initial_window_size; ///< What server_rwnd is topped up to
 
   // HTTP/2 frame sender
   void schedule_stream(Http2Stream *stream);
@@ -221,6 +242,7 @@ public:
   Http2SendADataFrameResult send_a_data_frame(Http2Stream *stream, size_t &payload_length);
   void send_headers_frame(Http2Stream *stream);
   void send_push_promise_frame(Http2Stream *stream, URL &url, const MIMEField *accept_encoding);
+  void cancel_push(Http2Stream *stream);
   void send_rst_stream_frame(Http2StreamId id, Http2ErrorCode ec);
   void send_settings_frame(const Http2ConnectionSettings &new_settings);
   void send_ping_frame(Http2StreamId id, uint8_t flag, const uint8_t *opaque_data);
@@ -267,6 +289,8 @@ public:
 
 private:
   unsigned _adjust_concurrent_stream();
+  void _send_rtt_ping();
+  void _grow_server_rwnd();
 
   // NOTE: 'stream_list' has only active streams.
   //   If given Stream Identifier is not found in stream_list and it is less
@@ -274,7 +298,9 @@ private:
   //   is CLOSED.
   //   If given Stream Identifier is not found in stream_list and it is greater
   //   than latest_streamid_in, the state of Stream is IDLE.
+  //   'stream_map' indexes the same streams by identifier.
   Queue<Http2Stream> stream_list;
+  Http2StreamMap<Http2Stream> stream_map;
   Http2StreamId latest_streamid_in  = 0;
   Http2StreamId latest_streamid_out = 0;
   int stream_requests               = 0;
@@ -288,6 +314,9 @@ private:
   // Counter for current active streams and streams in the process of shutting down
   uint32_t total_client_streams_count = 0;
 
+  // Counter for the streams above whose transaction runs on another thread
+  uint32_t distributed_streams_count = 0;
+
   // NOTE: Id of stream which MUST receive CONTINUATION frame.
   //   - [RFC 7540] 6.2 HEADERS
   //     "A HEADERS frame without the END_HEADERS flag set MUST be followed by a
@@ -301,6 +330,12 @@ private:
   bool fini_received                = false;
   int recursion                     = 0;
   Http2ShutdownState shutdown_state = NOT_INITIATED;
+
+  // Receive window auto-tuning
+  ink_hrtime _rtt              = 0; ///< Round trip time of the last PING
+  ink_hrtime _ping_sent_at     = 0; ///< Also the opaque data of the PING in flight
+  ink_hrtime _rwnd_refilled_at = 0;
+  int64_t _rwnd_growth         = 0; ///< Taken from Http2::max_window_memory
 };
 
 #endif // __HTTP2_CONNECTION_STATE_H__
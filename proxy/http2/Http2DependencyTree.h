@@ -5,6 +5,16 @@
   The original idea of Stream Priority Algorithm using Weighted Fair Queue (WFQ)
   Scheduling is invented by Kazuho Oku (H2O project).
 
+  Every node keeps its active descendants in a heap ordered by virtual finish time, the point.
+  Serving a node moves its point forward by the bytes sent divided by its weight, and a node
+  that becomes active starts at the virtual time of its parent, so a stream that was idle or
+  is new cannot claim the bandwidth its siblings already used. Nodes are indexed by stream
+  identifier, finding one does not walk the tree.
+
+  The tree also implements RFC 9218 Extensible Priorities. All streams are then children of the
+  root, ordered by urgency, non-incremental streams of an urgency are served in stream
+  identifier order and incremental ones take turns.
+
   @section license License
 
   Licensed to the Apache Software Foundation (ASF) under one
@@ -32,6 +42,7 @@
 #include "ts/PriorityQueue.h"
 
 #include "HTTP2.h"
+#include "Http2StreamMap.h"
 
 // TODO: K is a constant, 256 is temporal value.
 const static uint32_t K                               = 256;
@@ -48,7 +59,7 @@ public:
     queue = new PriorityQueue<Node *>();
   }
 
-  Node(uint32_t i, uint32_t w, uint32_t p, Node *n, void *t = nullptr) : id(i), weight(w), point(p), t(t), parent(n)
+  Node(uint32_t i, uint32_t w, uint64_t p, Node *n, void *t = nullptr) : id(i), weight(w), point(p), t(t), parent(n)
   {
     entry = new PriorityQueueEntry<Node *>(this);
     queue = new PriorityQueue<Node *>();
@@ -91,13 +102,16 @@ public:
     return t == nullptr;
   }
 
-  bool active     = false;
-  bool queued     = false;
-  uint32_t id     = HTTP2_PRIORITY_DEFAULT_STREAM_DEPENDENCY;
-  uint32_t weight = HTTP2_PRIORITY_DEFAULT_WEIGHT;
-  uint32_t point  = 0;
-  void *t         = nullptr;
-  Node *parent    = nullptr;
+  bool active      = false;
+  bool queued      = false;
+  uint32_t id      = HTTP2_PRIORITY_DEFAULT_STREAM_DEPENDENCY;
+  uint32_t weight  = HTTP2_PRIORITY_DEFAULT_WEIGHT;
+  uint64_t point   = 0;
+  uint64_t vtime   = 0; ///< Point of the child served last, where children joining the queue start.
+  uint8_t urgency  = HTTP2_PRIORITY_URGENCY_DEFAULT;
+  bool incremental = HTTP2_PRIORITY_INCREMENTAL_DEFAULT;
+  void *t          = nullptr;
+  Node *parent     = nullptr;
   DLL<Node> children;
   PriorityQueueEntry<Node *> *entry;
   PriorityQueue<Node *> *queue;
@@ -106,12 +120,18 @@ public:
 template <typename T> class Tree
 {
 public:
-  Tree(uint32_t max_concurrent_streams) : _max_depth(MIN(max_concurrent_streams, HTTP2_DEPENDENCY_TREE_MAX_DEPTH)) {}
+  /// @a extensible selects RFC 9218 Extensible Priorities instead of the RFC 7540 dependency tree.
+  Tree(uint32_t max_concurrent_streams, bool extensible = false)
+    : _max_depth(MIN(max_concurrent_streams, HTTP2_DEPENDENCY_TREE_MAX_DEPTH)), _extensible(extensible)
+  {
+  }
 
   ~Tree() { delete _root; }
   Node *find(uint32_t id);
   Node *find_shadow(uint32_t id);
   Node *add(uint32_t parent_id, uint32_t id, uint32_t weight, bool exclusive, T t);
+  Node *add(uint32_t id, uint8_t urgency, bool incremental, T t);
+  void set_urgency(Node *node, uint8_t urgency, bool incremental);
   void remove(Node *node);
   void reprioritize(uint32_t new_parent_id, uint32_t id, bool exclusive);
   void reprioritize(Node *node, uint32_t id, bool exclusive);
@@ -120,52 +140,96 @@ public:
   void deactivate(Node *node, uint32_t sent);
   void update(Node *node, uint32_t sent);
   uint32_t size() const;
+  bool
+  is_extensible() const
+  {
+    return _extensible;
+  }
 
 private:
-  Node *_find(Node *node, uint32_t id, uint32_t depth = 1);
+  Node *_find(uint32_t id);
   Node *_top(Node *node);
   void _change_parent(Node *new_parent, Node *node, bool exclusive);
+  void _enqueue(Node *parent, Node *node);
+  void _index(Node *node);
+  void _unindex(Node *node);
+
+  uint64_t
+  _urgency_point(uint8_t urgency, uint64_t order) const
+  {
+    return (static_cast<uint64_t>(urgency) << 56) | order;
+  }
 
   Node *_root = new Node(this);
   uint32_t _max_depth;
   uint32_t _node_count = 0;
+  bool _extensible     = false;
+  uint64_t _turn       = 0; ///< Hands out the turns of incremental streams.
+  Http2StreamMap<Node> _nodes;
 };
 
 template <typename T>
 Node *
-Tree<T>::_find(Node *node, uint32_t id, uint32_t depth)
+Tree<T>::_find(uint32_t id)
 {
-  if (node->id == id) {
-    return node;
+  if (id == _root->id) {
+    return _root;
   }
 
-  if (node->children.empty() || depth >= _max_depth) {
-    return nullptr;
+  // Nodes deeper than the limit are not reachable, dependencies on them start a new branch.
+  Node *node     = _nodes.find(id);
+  uint32_t depth = 1;
+  for (Node *n = node; n != nullptr && n != _root; n = n->parent) {
+    if (++depth > _max_depth) {
+      return nullptr;
+    }
   }
 
-  Node *result = nullptr;
-  for (Node *n = node->children.head; n; n = n->link.next) {
-    result = _find(n, id, ++depth);
-    if (result != nullptr) {
-      break;
-    }
+  return node;
+}
+
+template <typename T>
+void
+Tree<T>::_index(Node *node)
+{
+  // A node that could not be reached is replaced in the index by the one added for the same stream.
+  _nodes.remove(node->id);
+  _nodes.insert(node->id, node);
+}
+
+template <typename T>
+void
+Tree<T>::_unindex(Node *node)
+{
+  if (_nodes.find(node->id) == node) {
+    _nodes.remove(node->id);
   }
+}
 
-  return result;
+// A node joining the queue of @a parent starts no earlier than the child served last.
+template <typename T>
+void
+Tree<T>::_enqueue(Node *parent, Node *node)
+{
+  if (!_extensible && node->point < parent->vtime) {
+    node->point = parent->vtime;
+  }
+  parent->queue->push(node->entry);
+  node->queued = true;
 }
 
 template <typename T>
 Node *
 Tree<T>::find_shadow(uint32_t id)
 {
-  return _find(_root, id);
+  return _find(id);
 }
 
 template <typename T>
 Node *
 Tree<T>::find(uint32_t id)
 {
-  Node *n = _find(_root, id);
+  Node *n = _find(id);
   return n == nullptr ? nullptr : (n->is_shadow() ? nullptr : n);
 }
 
@@ -193,7 +257,7 @@ Tree<T>::add(uint32_t parent_id, uint32_t id, uint32_t weight, bool exclusive, T
     while (Node *child = parent->children.pop()) {
       if (child->queued) {
         parent->queue->erase(child->entry);
-        node->queue->push(child->entry);
+        _enqueue(node, child);
       }
       node->children.push(child);
       child->parent = node;
@@ -202,14 +266,45 @@ Tree<T>::add(uint32_t parent_id, uint32_t id, uint32_t weight, bool exclusive, T
 
   parent->children.push(node);
   if (!node->queue->empty()) {
-    parent->queue->push(node->entry);
-    node->queued = true;
+    _enqueue(parent, node);
   }
 
+  _index(node);
+  ++_node_count;
+  return node;
+}
+
+template <typename T>
+Node *
+Tree<T>::add(uint32_t id, uint8_t urgency, bool incremental, T t)
+{
+  ink_assert(_extensible);
+
+  Node *node        = new Node(id, HTTP2_PRIORITY_DEFAULT_WEIGHT, 0, _root, t);
+  node->urgency     = urgency;
+  node->incremental = incremental;
+  node->point       = _urgency_point(urgency, incremental ? ++_turn : id);
+  _root->children.push(node);
+
+  _index(node);
   ++_node_count;
   return node;
 }
 
+template <typename T>
+void
+Tree<T>::set_urgency(Node *node, uint8_t urgency, bool incremental)
+{
+  ink_assert(_extensible);
+
+  node->urgency     = urgency;
+  node->incremental = incremental;
+  node->point       = _urgency_point(urgency, incremental ? ++_turn : node->id);
+  if (node->queued) {
+    node->parent->queue->update(node->entry);
+  }
+}
+
 template <typename T>
 void
 Tree<T>::remove(Node *node)
@@ -226,8 +321,9 @@ Tree<T>::remove(Node *node)
 
   // Push queue entries
   while (!node->queue->empty()) {
-    parent->queue->push(node->queue->top());
+    Node *child = node->queue->top()->node;
     node->queue->pop();
+    _enqueue(parent, child);
   }
 
   // Push children
@@ -242,6 +338,7 @@ Tree<T>::remove(Node *node)
     remove(parent);
   }
 
+  _unindex(node);
   --_node_count;
   delete node;
 }
@@ -311,7 +408,7 @@ Tree<T>::_change_parent(Node *node, Node *new_parent, bool exclusive)
     while (Node *child = new_parent->children.pop()) {
       if (child->queued) {
         child->parent->queue->erase(child->entry);
-        node->queue->push(child->entry);
+        _enqueue(node, child);
       }
 
       node->children.push(child);
@@ -325,9 +422,8 @@ Tree<T>::_change_parent(Node *node, Node *new_parent, bool exclusive)
   if (node->active || !node->queue->empty()) {
     Node *current = node;
     while (current->parent != nullptr && !current->queued) {
-      current->parent->queue->push(current->entry);
-      current->queued = true;
-      current         = current->parent;
+      _enqueue(current->parent, current);
+      current = current->parent;
     }
   }
 }
@@ -365,9 +461,8 @@ Tree<T>::activate(Node *node)
   node->active = true;
 
   while (node->parent != nullptr && !node->queued) {
-    node->parent->queue->push(node->entry);
-    node->queued = true;
-    node         = node->parent;
+    _enqueue(node->parent, node);
+    node = node->parent;
   }
 }
 
@@ -392,13 +487,20 @@ void
 Tree<T>::update(Node *node, uint32_t sent)
 {
   while (node->parent != nullptr) {
-    node->point += sent * K / (node->weight + 1);
+    if (_extensible) {
+      // Non-incremental streams keep their place until they are done
+      if (node->incremental) {
+        node->point = _urgency_point(node->urgency, ++_turn);
+      }
+    } else {
+      node->parent->vtime = std::max(node->parent->vtime, node->point);
+      node->point += static_cast<uint64_t>(sent) * K / (node->weight + 1);
+    }
 
     if (node->queued) {
       node->parent->queue->update(node->entry, true);
     } else {
-      node->parent->queue->push(node->entry);
-      node->queued = true;
+      _enqueue(node->parent, node);
     }
 
     node = node->parent;
@@ -0,0 +1,129 @@
+/** @file
+
+  HTTP/2 server push diary
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#ifndef __HTTP2_PUSH_DIARY_H__
+#define __HTTP2_PUSH_DIARY_H__
+
+#include "ts/ink_memory.h"
+#include "ts/HashSip.h"
+
+/**
+  The URLs a client holds on a connection, the ones it requested and the ones pushed to it.
+
+  A Bloom filter in the manner of a cache digest, 16 bits and 7 probes per URL for a false positive
+  rate near 1 in 2000. A false positive only costs a push that is not made. The filter is cleared
+  once it has seen @c capacity URLs, so a long lived connection does not end up matching everything.
+ */
+class Http2PushDiary
+{
+public:
+  Http2PushDiary() {}
+  ~Http2PushDiary() { ats_free(_bits); }
+
+  /// Set the number of URLs kept, 0 turns the diary off.
+  void
+  init(uint32_t capacity)
+  {
+    clear();
+    _capacity = capacity;
+  }
+
+  /// Release the filter, the diary can be used again after @c init.
+  void
+  clear()
+  {
+    ats_free(_bits);
+    _bits     = nullptr;
+    _mask     = 0;
+    _count    = 0;
+    _capacity = 0;
+  }
+
+  bool
+  contains(const char *url, int url_len) const
+  {
+    if (_bits == nullptr) {
+      return false;
+    }
+
+    uint64_t h1, h2;
+    _hash(url, url_len, h1, h2);
+    for (int i = 0; i < PROBES; ++i) {
+      uint64_t bit = (h1 + i * h2) & _mask;
+      if ((_bits[bit / 64] & (1ULL << (bit % 64))) == 0) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void
+  add(const char *url, int url_len)
+  {
+    if (_capacity == 0) {
+      return;
+    }
+    if (_bits == nullptr) {
+      uint64_t nbits = 64;
+      while (nbits < static_cast<uint64_t>(_capacity) * BITS_PER_URL) {
+        nbits <<= 1;
+      }
+      _bits = static_cast<uint64_t *>(ats_calloc(nbits / 64, sizeof(uint64_t)));
+      _mask = nbits - 1;
+    } else if (_count >= _capacity) {
+      memset(_bits, 0, (_mask + 1) / 8);
+      _count = 0;
+    }
+
+    uint64_t h1, h2;
+    _hash(url, url_len, h1, h2);
+    for (int i = 0; i < PROBES; ++i) {
+      uint64_t bit = (h1 + i * h2) & _mask;
+      _bits[bit / 64] |= 1ULL << (bit % 64);
+    }
+    ++_count;
+  }
+
+private:
+  static const int PROBES       = 7;
+  static const int BITS_PER_URL = 16;
+
+  // Double hashing, the probes are h1 + i * h2 with an odd h2 so they cover the whole filter.
+  static void
+  _hash(const char *url, int url_len, uint64_t &h1, uint64_t &h2)
+  {
+    ATSHash64Sip24 hash;
+    hash.update(url, url_len);
+    hash.final();
+    h1 = hash.get();
+    h2 = (h1 >> 32) | 1;
+  }
+
+  uint64_t *_bits    = nullptr;
+  uint64_t _mask     = 0;
+  uint32_t _count    = 0;
+  uint32_t _capacity = 0;
+};
+
+#endif // __HTTP2_PUSH_DIARY_H__
@@ -58,12 +58,18 @@ Http2Stream::main_event_handler(int event, void *edata)
     read_event = nullptr;
   } else if (e == write_event) {
     write_event = nullptr;
+  } else if (e == _xmit_event) {
+    _xmit_event = nullptr;
   }
 
   switch (event) {
   case VC_EVENT_ACTIVE_TIMEOUT:
   case VC_EVENT_INACTIVITY_TIMEOUT:
     if (current_reader && read_vio.ntodo() > 0) {
+      if (_sm_thread) {
+        send_tracked_event(nullptr, event, &read_vio);
+        break;
+      }
       MUTEX_TRY_LOCK(lock, read_vio.mutex, this_ethread());
       if (lock.is_locked()) {
         read_vio._cont->handleEvent(event, &read_vio);
@@ -71,6 +77,10 @@ Http2Stream::main_event_handler(int event, void *edata)
         this_ethread()->schedule_imm(read_vio._cont, event, &read_vio);
       }
     } else if (current_reader && write_vio.ntodo() > 0) {
+      if (_sm_thread) {
+        send_tracked_event(nullptr, event, &write_vio);
+        break;
+      }
       MUTEX_TRY_LOCK(lock, write_vio.mutex, this_ethread());
       if (lock.is_locked()) {
         write_vio._cont->handleEvent(event, &write_vio);
@@ -79,6 +89,9 @@ Http2Stream::main_event_handler(int event, void *edata)
       }
     }
     break;
+  case HTTP2_SESSION_EVENT_XMIT:
+    send_pending_frames();
+    break;
   case VC_EVENT_WRITE_READY:
   case VC_EVENT_WRITE_COMPLETE:
     inactive_timeout_at = Thread::get_hrtime() + inactive_timeout;
@@ -143,6 +156,14 @@ Http2Stream::send_request(Http2ConnectionState &cstate)
   // Convert header to HTTP/1.1 format
   http2_convert_header_from_2_to_1_1(&_req_header);
 
+  // What the client requested is not pushed to it again
+  if (http2_is_client_streamid(this->get_id()) && cstate.client_settings.get(HTTP2_SETTINGS_ENABLE_PUSH)) {
+    char buf[2048];
+    int len;
+    const char *url = _req_header.url_get()->string_get_buf(buf, sizeof(buf), &len);
+    cstate.ua_session->add_url_to_pushed_table(url, len);
+  }
+
   // Write header to a buffer.  Borrowing logic from HttpSM::write_header_into_buffer.
   // Seems like a function like this ought to be in HTTPHdr directly
   int bufindex;
@@ -215,7 +236,10 @@ Http2Stream::change_state(uint8_t type, uint8_t flags)
     break;
 
   case Http2StreamState::HTTP2_STREAM_STATE_RESERVED_LOCAL:
-    if (type == HTTP2_FRAME_TYPE_HEADERS) {
+    if (type == HTTP2_FRAME_TYPE_RST_STREAM) {
+      // Either side may reset a push before its response starts
+      _state = Http2StreamState::HTTP2_STREAM_STATE_CLOSED;
+    } else if (type == HTTP2_FRAME_TYPE_HEADERS) {
       if (flags & HTTP2_FLAGS_HEADERS_END_HEADERS) {
         _state = Http2StreamState::HTTP2_STREAM_STATE_HALF_CLOSED_REMOTE;
       }
@@ -271,6 +295,7 @@ Http2Stream::change_state(uint8_t type, uint8_t flags)
 VIO *
 Http2Stream::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
 {
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
   if (buf) {
     read_vio.buffer.writer_for(buf);
   } else {
@@ -294,6 +319,7 @@ Http2Stream::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
 VIO *
 Http2Stream::do_io_write(Continuation *c, int64_t nbytes, IOBufferReader *abuffer, bool owner)
 {
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
   if (abuffer) {
     write_vio.buffer.reader_for(abuffer);
   } else {
@@ -322,11 +348,18 @@ Http2Stream::do_io_close(int /* flags */)
     // remaining IO operations back to client should be abandoned.  The SM-side buffers backing these operations will be deleted
     // by the time this is called from transaction_done.
     closed = true;
+    // The SM is done with its VIOs, nothing relayed to it is of use any more
+    _sm_read_event = _sm_write_event = 0;
 
     if (parent && this->is_client_state_writeable()) {
       // Make sure any trailing end of stream frames are sent
       // Wee will be removed at send_data_frames or closing connection phase
-      static_cast<Http2ClientSession *>(parent)->connection_state.send_data_frames(this);
+      if (this_ethread() != _thread) {
+        _xmit_close = true;
+        schedule_xmit();
+      } else {
+        static_cast<Http2ClientSession *>(parent)->connection_state.send_data_frames(this);
+      }
     }
 
     clear_timers();
@@ -347,6 +380,12 @@ Http2Stream::transaction_done()
     cross_thread_event->cancel();
     cross_thread_event = nullptr;
   }
+  if (_sm_event) {
+    _sm_event->cancel();
+    _sm_event = nullptr;
+  }
+  _sm_pending    = 0;
+  _sm_read_event = _sm_write_event = 0;
 
   if (!closed) {
     do_io_close(); // Make sure we've been closed.  If we didn't close the parent session better still be open
@@ -360,7 +399,12 @@ Http2Stream::transaction_done()
     // Schedule the destroy to occur after we unwind here.  IF we call directly, may delete with reference on the stack.
     terminate_stream = true;
     if (terminate_stream && reentrancy_count == 0) {
-      destroy();
+      // The session thread destroys the stream of an SM that ran elsewhere
+      if (this_ethread() != _thread) {
+        schedule_xmit();
+      } else {
+        destroy();
+      }
     }
   }
 }
@@ -396,7 +440,7 @@ Http2Stream::initiating_close()
     if (current_reader) {
       // Push out any last IO events
       if (write_vio._cont) {
-        SCOPED_MUTEX_LOCK(lock, write_vio.mutex, this_ethread());
+        SCOPED_MUTEX_LOCK(lock, vio_mutex(write_vio), this_ethread());
         // Are we done?
         if (write_vio.nbytes == write_vio.ndone) {
           Debug("http2_stream", "handle write from destroy stream=%d event=%d", this->_id, VC_EVENT_WRITE_COMPLETE);
@@ -412,10 +456,12 @@ Http2Stream::initiating_close()
     if (current_reader && read_vio._cont) {
       // Only bother with the EOS if we haven't sent the write complete
       if (!sent_write_complete) {
-        SCOPED_MUTEX_LOCK(lock, read_vio.mutex, this_ethread());
+        SCOPED_MUTEX_LOCK(lock, vio_mutex(read_vio), this_ethread());
         Debug("http2_stream", "send EOS to read cont stream=%d", this->_id);
         read_event = send_tracked_event(read_event, VC_EVENT_EOS, &read_vio);
       }
+    } else if (current_reader && _sm_thread) {
+      relay_to_sm(SM_RELAY_ERROR);
     } else if (current_reader) {
       SCOPED_MUTEX_LOCK(lock, current_reader->mutex, this_ethread());
       current_reader->handleEvent(VC_EVENT_ERROR);
@@ -430,6 +476,16 @@ Http2Stream::initiating_close()
 Event *
 Http2Stream::send_tracked_event(Event *event, int send_event, VIO *vio)
 {
+  if (_sm_thread) {
+    // The relay delivers the event on the SM thread, a pending READY does not replace anything else
+    int &pending = (vio == &read_vio) ? _sm_read_event : _sm_write_event;
+    if (pending == 0 || pending == VC_EVENT_READ_READY || pending == VC_EVENT_WRITE_READY) {
+      pending = send_event;
+    }
+    relay_to_sm(0);
+    return nullptr;
+  }
+
   if (event != nullptr) {
     if (event->callback_event != send_event) {
       event->cancel();
@@ -450,7 +506,15 @@ Http2Stream::update_read_request(int64_t read_len, bool call_update)
   if (closed || parent == nullptr || current_reader == nullptr || read_vio.mutex == nullptr) {
     return;
   }
-  if (this->get_thread() != this_ethread()) {
+  if (_sm_thread) {
+    // Only the SM thread writes to the SM's buffer, and it sends its events through the relay
+    SCOPED_MUTEX_LOCK(stream_lock, this->mutex, this_ethread());
+    if (this_ethread() != _sm_thread) {
+      relay_to_sm(SM_RELAY_READ);
+      return;
+    }
+    call_update = false;
+  } else if (this->get_thread() != this_ethread()) {
     SCOPED_MUTEX_LOCK(stream_lock, this->mutex, this_ethread());
     if (cross_thread_event == nullptr) {
       // Send to the right thread
@@ -458,11 +522,10 @@ Http2Stream::update_read_request(int64_t read_len, bool call_update)
     }
     return;
   }
-  ink_release_assert(this->get_thread() == this_ethread());
+  SCOPED_MUTEX_LOCK(stream_lock, this->mutex, this_ethread());
   SCOPED_MUTEX_LOCK(lock, read_vio.mutex, this_ethread());
   if (read_vio.nbytes > 0 && read_vio.ndone <= read_vio.nbytes) {
     // If this vio has a different buffer, we must copy
-    ink_release_assert(this_ethread() == this->_thread);
     if (read_vio.buffer.writer() != (&request_buffer)) {
       int64_t num_to_read = read_vio.nbytes - read_vio.ndone;
       if (num_to_read > read_len) {
@@ -509,7 +572,14 @@ Http2Stream::update_write_request(IOBufferReader *buf_reader, int64_t write_len,
   if (!this->is_client_state_writeable() || closed || parent == nullptr || write_vio.mutex == nullptr) {
     return retval;
   }
-  if (this->get_thread() != this_ethread()) {
+  if (_sm_thread) {
+    // Only the SM thread reads from the SM's buffer
+    SCOPED_MUTEX_LOCK(stream_lock, this->mutex, this_ethread());
+    if (this_ethread() != _sm_thread) {
+      relay_to_sm(SM_RELAY_WRITE);
+      return retval;
+    }
+  } else if (this->get_thread() != this_ethread()) {
     SCOPED_MUTEX_LOCK(stream_lock, this->mutex, this_ethread());
     if (cross_thread_event == nullptr) {
       // Send to the right thread
@@ -517,10 +587,9 @@ Http2Stream::update_write_request(IOBufferReader *buf_reader, int64_t write_len,
     }
     return retval;
   }
-  ink_release_assert(this->get_thread() == this_ethread());
-  Http2ClientSession *parent = static_cast<Http2ClientSession *>(this->get_parent());
   // Copy over data in the abuffer into resp_buffer.  Then schedule a WRITE_READY or
   // WRITE_COMPLETE event
+  SCOPED_MUTEX_LOCK(stream_lock, this->mutex, this_ethread());
   SCOPED_MUTEX_LOCK(lock, write_vio.mutex, this_ethread());
   int64_t total_added = 0;
   if (write_vio.nbytes > 0 && write_vio.ndone < write_vio.nbytes) {
@@ -538,11 +607,30 @@ Http2Stream::update_write_request(IOBufferReader *buf_reader, int64_t write_len,
       total_added += bytes_added;
     }
   }
+  write_vio.ndone += total_added;
+
+  if (_sm_thread) {
+    // The frames are made on the session thread
+    if (total_added > 0) {
+      _xmit_added += total_added;
+      schedule_xmit();
+    }
+    return retval;
+  }
+
+  return process_write_data(total_added, call_update);
+}
+
+// Parses the response header and sends the frames for the data added to the response buffer
+bool
+Http2Stream::process_write_data(int64_t total_added, bool call_update)
+{
+  bool retval                = true;
+  Http2ClientSession *parent = static_cast<Http2ClientSession *>(this->get_parent());
 
   bool is_done = false;
   this->response_process_data(is_done);
   if (total_added > 0 || is_done) {
-    write_vio.ndone += total_added;
     int send_event = (write_vio.nbytes == write_vio.ndone || is_done) ? VC_EVENT_WRITE_COMPLETE : VC_EVENT_WRITE_READY;
 
     // Process the new data
@@ -555,6 +643,12 @@ Http2Stream::update_write_request(IOBufferReader *buf_reader, int64_t write_len,
       case PARSE_RESULT_DONE: {
         this->response_header_done = true;
 
+        // [RFC 7540] 8.2 A pushed response is for the client's cache, anything but a 200 is of no use to it
+        if (!http2_is_client_streamid(this->get_id()) && this->response_header.status_get() != HTTP_STATUS_OK) {
+          parent->connection_state.cancel_push(this);
+          break;
+        }
+
         // Send the response header back
         parent->connection_state.send_headers_frame(this);
 
@@ -692,6 +786,7 @@ Http2Stream::destroy()
   // Drop references to all buffer data
   request_buffer.clear();
   response_buffer.clear();
+  _sm_request_buffer.clear();
 
   // Free the mutexes in the VIO
   read_vio.mutex.clear();
@@ -704,6 +799,12 @@ Http2Stream::destroy()
   super::destroy();
   clear_timers();
   clear_io_events();
+  if (_xmit_event) {
+    _xmit_event->cancel();
+    _xmit_event = nullptr;
+  }
+  ink_assert(_sm_event == nullptr);
+  _sm_relay.mutex.clear();
 
   THREAD_FREE(this, http2StreamAllocator, this_ethread());
 }
@@ -776,24 +877,28 @@ Http2Stream::response_get_data_reader() const
   return (chunked) ? chunked_handler.dechunked_reader : response_reader;
 }
 
+// The stream timers are the stream's own and run on the session thread. A distributed SM sets them holding its
+// mutex, which may be taken before the stream's.
 void
 Http2Stream::set_active_timeout(ink_hrtime timeout_in)
 {
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
   active_timeout = timeout_in;
   clear_active_timer();
   if (active_timeout > 0) {
-    active_event = this_ethread()->schedule_in(this, active_timeout);
+    active_event = this->get_thread()->schedule_in(this, active_timeout);
   }
 }
 
 void
 Http2Stream::set_inactivity_timeout(ink_hrtime timeout_in)
 {
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
   inactive_timeout = timeout_in;
   if (inactive_timeout > 0) {
     inactive_timeout_at = Thread::get_hrtime() + inactive_timeout;
     if (!inactive_event) {
-      inactive_event = this_ethread()->schedule_every(this, HRTIME_SECONDS(1));
+      inactive_event = this->get_thread()->schedule_every(this, HRTIME_SECONDS(1));
     }
   } else {
     clear_inactive_timer();
@@ -847,7 +952,160 @@ Http2Stream::clear_io_events()
 void
 Http2Stream::release(IOBufferReader *r)
 {
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
   super::release(r);
   current_reader = nullptr; // State machine is on its own way down.
   this->do_io_close();
 }
+
+void
+Http2Stream::start_transaction()
+{
+  EThread *sm_thread = Http2::distribute_transactions ? eventProcessor.assign_thread(ET_NET) : _thread;
+  if (sm_thread == _thread) {
+    super::start_transaction();
+    return;
+  }
+
+  // The SM gets a mutex of its own and starts on the other thread, its cache and origin server work stays there
+  Debug("http2_stream", "stream %d runs its transaction on another thread", this->_id);
+  HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_DISTRIBUTED_TRANSACTIONS_COUNT, _thread);
+  static_cast<Http2ClientSession *>(parent)->connection_state.add_distributed_stream();
+  _sm_thread            = sm_thread;
+  current_reader->mutex = new_ProxyMutex();
+  _sm_relay.mutex       = current_reader->mutex;
+
+  // The SM reads the request from a buffer of its own, the data is moved over to it on the SM thread
+  sm_reader = _sm_request_buffer.alloc_reader();
+
+  // The SM does not touch the session from its thread
+  super::set_session_active();
+
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
+  relay_to_sm(SM_RELAY_START);
+}
+
+void
+Http2Stream::set_session_active()
+{
+  if (!_sm_thread) {
+    super::set_session_active();
+  }
+}
+
+Action *
+Http2Stream::adjust_thread(Continuation *cont, int event, void *data)
+{
+  if (_sm_thread) {
+    return _sm_thread != this_ethread() ? _sm_thread->schedule_imm(cont, event, data) : nullptr;
+  }
+  return super::adjust_thread(cont, event, data);
+}
+
+// The mutex to take on the session thread before signaling a VIO, the session thread does not wait for the mutex of
+// an SM on another thread
+Ptr<ProxyMutex> &
+Http2Stream::vio_mutex(VIO &vio)
+{
+  return (_sm_thread && this_ethread() != _sm_thread) ? this->mutex : vio.mutex;
+}
+
+// Leaves work for the relay, the stream mutex is held
+void
+Http2Stream::relay_to_sm(uint8_t work)
+{
+  if (current_reader == nullptr) {
+    return;
+  }
+  _sm_pending |= work;
+  if (_sm_event == nullptr) {
+    _sm_event = _sm_thread->schedule_imm(&_sm_relay);
+  }
+}
+
+// Runs on the SM thread with the SM's mutex held
+void
+Http2Stream::deliver_sm_events()
+{
+  uint8_t work;
+  int read_event_code, write_event_code;
+  {
+    SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
+    _sm_event = nullptr;
+    ++reentrancy_count;
+    if (_sm_pending & SM_RELAY_READ) {
+      update_read_request(INT64_MAX, false);
+    }
+    if (_sm_pending & SM_RELAY_WRITE) {
+      update_write_request(write_vio.get_reader(), INT64_MAX, false);
+    }
+    // A close supersedes whatever READY was still queued
+    work             = _sm_pending;
+    read_event_code  = (work & SM_RELAY_ERROR) ? 0 : _sm_read_event;
+    write_event_code = (work & SM_RELAY_ERROR) ? 0 : _sm_write_event;
+    _sm_pending      = 0;
+    _sm_read_event = _sm_write_event = 0;
+  }
+
+  // The SM is called without the stream mutex, so that the session thread is not held up by it
+  if ((work & SM_RELAY_START) && current_reader) {
+    current_reader->attach_client_session(this, sm_reader);
+  }
+  if (read_event_code && read_vio._cont && current_reader) {
+    read_vio._cont->handleEvent(read_event_code, &read_vio);
+  }
+  if (write_event_code && write_vio._cont && current_reader) {
+    write_vio._cont->handleEvent(write_event_code, &write_vio);
+  }
+  if ((work & SM_RELAY_ERROR) && current_reader) {
+    // The SM may have set up its VIOs since the close was relayed, tell it the way initiating_close would have
+    if (read_vio._cont) {
+      read_vio._cont->handleEvent(VC_EVENT_EOS, &read_vio);
+    } else if (write_vio._cont) {
+      write_vio._cont->handleEvent(VC_EVENT_EOS, &write_vio);
+    } else {
+      current_reader->handleEvent(VC_EVENT_ERROR);
+    }
+  }
+
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
+  if (--reentrancy_count == 0 && terminate_stream) {
+    schedule_xmit();
+  }
+}
+
+// Hands the framing to the session thread, the stream mutex is held
+void
+Http2Stream::schedule_xmit()
+{
+  if (_xmit_event == nullptr) {
+    _xmit_event = _thread->schedule_imm(this, HTTP2_SESSION_EVENT_XMIT);
+  }
+}
+
+void
+Http2Stream::send_pending_frames()
+{
+  int64_t total_added = _xmit_added;
+  _xmit_added         = 0;
+  if (!this->is_client_state_writeable() || parent == nullptr) {
+    return;
+  }
+
+  // What the SM wrote before closing still goes out first, the HEADERS frame may be part of it
+  if (!closed || total_added > 0) {
+    process_write_data(total_added, false);
+  }
+  if (closed && _xmit_close) {
+    // The trailing frames of do_io_close on the SM thread
+    _xmit_close = false;
+    static_cast<Http2ClientSession *>(parent)->connection_state.send_data_frames(this);
+  }
+}
+
+int
+Http2StreamSMRelay::main_event_handler(int /* event ATS_UNUSED */, void * /* edata ATS_UNUSED */)
+{
+  stream->deliver_sm_events();
+  return EVENT_DONE;
+}
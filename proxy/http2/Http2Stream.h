@@ -35,6 +35,16 @@ class Http2ConnectionState;
 
 typedef Http2DependencyTree::Tree<Http2Stream *> DependencyTree;
 
+// Carries the events of a stream to its HttpSM when the SM runs on another thread, it shares the SM's mutex
+class Http2StreamSMRelay : public Continuation
+{
+public:
+  Http2StreamSMRelay() : Continuation(nullptr) { SET_HANDLER(&Http2StreamSMRelay::main_event_handler); }
+  int main_event_handler(int event, void *edata);
+
+  Http2Stream *stream = nullptr;
+};
+
 class Http2Stream : public ProxyClientTransaction
 {
 public:
@@ -51,6 +61,7 @@ public:
     _start_time       = Thread::get_hrtime();
     _thread           = this_ethread();
     this->client_rwnd = initial_rwnd;
+    _sm_relay.stream  = this;
     HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_CURRENT_CLIENT_STREAM_COUNT, _thread);
     HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_TOTAL_CLIENT_STREAM_COUNT, _thread);
     sm_reader = request_reader = request_buffer.alloc_reader();
@@ -127,6 +138,12 @@ public:
     _req_header.copy(&h2_headers);
   }
 
+  HTTPHdr *
+  get_request_header()
+  {
+    return &_req_header;
+  }
+
   // Check entire DATA payload length if content-length: header is exist
   void
   increment_data_length(uint64_t length)
@@ -154,6 +171,7 @@ public:
   virtual void transaction_done() override;
   void send_response_body();
   void push_promise(URL &url, const MIMEField *accept_encoding);
+  void deliver_sm_events();
 
   // Stream level window size
   ssize_t client_rwnd;
@@ -184,6 +202,16 @@ public:
     return _thread;
   }
 
+  // Whether the HttpSM runs on another thread than the stream, see Http2::distribute_transactions
+  bool
+  is_sm_distributed() const
+  {
+    return _sm_thread != nullptr;
+  }
+
+  Action *adjust_thread(Continuation *cont, int event, void *data) override;
+  void set_session_active() override;
+
   IOBufferReader *response_get_data_reader() const;
   bool
   response_is_chunked() const
@@ -199,6 +227,17 @@ public:
     return false;
   }
 
+  // Half close is a property of the connection, which the stream shares with the other streams of its session
+  void
+  set_half_close_flag(bool flag) override
+  {
+  }
+  bool
+  get_half_close_flag() const override
+  {
+    return false;
+  }
+
   virtual void set_active_timeout(ink_hrtime timeout_in) override;
   virtual void set_inactivity_timeout(ink_hrtime timeout_in) override;
   virtual void cancel_inactivity_timeout() override;
@@ -226,7 +265,22 @@ public:
     return is_first_transaction_flag;
   }
 
+protected:
+  void start_transaction() override;
+
 private:
+  // Work left for the relay on the SM thread
+  static const uint8_t SM_RELAY_START = 0x01;
+  static const uint8_t SM_RELAY_READ  = 0x02;
+  static const uint8_t SM_RELAY_WRITE = 0x04;
+  static const uint8_t SM_RELAY_ERROR = 0x08;
+
+  void relay_to_sm(uint8_t work);
+  void schedule_xmit();
+  void send_pending_frames();
+  bool process_write_data(int64_t total_added, bool call_update);
+  Ptr<ProxyMutex> &vio_mutex(VIO &vio);
+
   void response_initialize_data_handling(bool &is_done);
   void response_process_data(bool &is_done);
   bool response_is_data_available() const;
@@ -286,6 +340,21 @@ private:
 
   Event *read_event  = nullptr;
   Event *write_event = nullptr;
+
+  // With the HttpSM on another thread, the session thread keeps the framing and the SM thread moves the data
+  // between the SM's buffers and the stream's. The stream mutex is taken after the SM's, never the other way,
+  // and the session thread does not wait for the SM's mutex. The relay and the xmit event carry the work over.
+  EThread *_sm_thread = nullptr;
+  Http2StreamSMRelay _sm_relay;
+  MIOBuffer _sm_request_buffer = CLIENT_CONNECTION_FIRST_READ_BUFFER_SIZE_INDEX;
+  Event *_sm_event    = nullptr;
+  uint8_t _sm_pending = 0;
+  int _sm_read_event  = 0;
+  int _sm_write_event = 0;
+
+  Event *_xmit_event  = nullptr;
+  int64_t _xmit_added = 0;
+  bool _xmit_close    = false;
 };
 
 extern ClassAllocator<Http2Stream> http2StreamAllocator;
@@ -0,0 +1,159 @@
+/** @file
+
+  HTTP/2 stream identifier map
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#ifndef __HTTP2_STREAM_MAP_H__
+#define __HTTP2_STREAM_MAP_H__
+
+#include "ts/ink_memory.h"
+#include "ts/ink_assert.h"
+
+#include "HTTP2.h"
+
+/**
+  Maps the identifiers of the open streams of a connection to their objects.
+
+  Open addressing with linear probing, the table is kept at most half full and entries are shifted
+  back on removal so lookups never go through tombstones. Identifier 0 is the connection itself and
+  never a key, it marks the empty slots. The map does not own the objects and has no order, the
+  connection keeps its streams on a list for that.
+ */
+template <typename T> class Http2StreamMap
+{
+public:
+  Http2StreamMap() {}
+  ~Http2StreamMap() { ats_free(_slots); }
+
+  T *
+  find(Http2StreamId id) const
+  {
+    if (_count == 0) {
+      return nullptr;
+    }
+    for (uint32_t i = _home(id);; i = (i + 1) & _mask) {
+      if (_slots[i].id == id) {
+        return _slots[i].value;
+      }
+      if (_slots[i].id == 0) {
+        return nullptr;
+      }
+    }
+  }
+
+  /// Add @a value as stream @a id, which must not be in the map already.
+  void
+  insert(Http2StreamId id, T *value)
+  {
+    ink_assert(id != 0);
+    if ((_count + 1) * 2 > _mask + 1) {
+      _resize(_slots ? (_mask + 1) * 2 : 16);
+    }
+
+    uint32_t i = _home(id);
+    while (_slots[i].id != 0) {
+      ink_assert(_slots[i].id != id);
+      i = (i + 1) & _mask;
+    }
+    _slots[i].id    = id;
+    _slots[i].value = value;
+    ++_count;
+  }
+
+  /// @return @c true if stream @a id was in the map.
+  bool
+  remove(Http2StreamId id)
+  {
+    if (_count == 0) {
+      return false;
+    }
+
+    uint32_t i = _home(id);
+    while (_slots[i].id != id) {
+      if (_slots[i].id == 0) {
+        return false;
+      }
+      i = (i + 1) & _mask;
+    }
+
+    // Shift back the entries of the cluster that would no longer be reachable from their home slot.
+    for (uint32_t j = (i + 1) & _mask; _slots[j].id != 0; j = (j + 1) & _mask) {
+      uint32_t home = _home(_slots[j].id);
+      if (((j - home) & _mask) >= ((j - i) & _mask)) {
+        _slots[i] = _slots[j];
+        i         = j;
+      }
+    }
+    _slots[i].id    = 0;
+    _slots[i].value = nullptr;
+    --_count;
+
+    return true;
+  }
+
+  uint32_t
+  size() const
+  {
+    return _count;
+  }
+
+private:
+  struct Slot {
+    Http2StreamId id;
+    T *value;
+  };
+
+  // Fibonacci hashing, identifiers of a connection are all odd or all even and mostly sequential.
+  uint32_t
+  _home(Http2StreamId id) const
+  {
+    return (id * 2654435769U) >> _shift;
+  }
+
+  void
+  _resize(uint32_t n_slots)
+  {
+    Slot *slots   = _slots;
+    uint32_t size = _slots ? _mask + 1 : 0;
+
+    _slots = static_cast<Slot *>(ats_calloc(n_slots, sizeof(Slot)));
+    _mask  = n_slots - 1;
+    _shift = 32;
+    for (uint32_t n = n_slots; n > 1; n >>= 1) {
+      --_shift;
+    }
+    _count = 0;
+
+    for (uint32_t i = 0; i < size; ++i) {
+      if (slots[i].id != 0) {
+        insert(slots[i].id, slots[i].value);
+      }
+    }
+    ats_free(slots);
+  }
+
+  Slot *_slots    = nullptr;
+  uint32_t _mask  = 0;
+  uint32_t _shift = 32;
+  uint32_t _count = 0;
+};
+
+#endif // __HTTP2_STREAM_MAP_H__
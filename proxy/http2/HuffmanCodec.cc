@@ -25,6 +25,7 @@
 #include "ts/ink_platform.h"
 #include "ts/ink_memory.h"
 #include "ts/ink_defs.h"
+#include "ts/ink_assert.h"
 
 struct huffman_entry {
   uint32_t code_as_hex;
@@ -72,20 +73,42 @@ static const huffman_entry huffman_table[] = {
 
 typedef struct node {
   node *left, *right;
-  char ascii_code;
+  uint16_t symbol;
+  uint8_t state; // Decoder state of an internal node
   bool leaf_node;
 } Node;
 
-Node *HUFFMAN_TREE_ROOT;
+//
+// The decoder is a finite state machine that consumes 4 bits at a time. A state is an internal
+// node of the Huffman tree, the root being state 0. Since no code is shorter than 5 bits, a
+// nibble completes at most one symbol.
+//
+enum {
+  HUFFMAN_DECODE_EMIT   = 0x01, // A symbol was completed
+  HUFFMAN_DECODE_ACCEPT = 0x02, // The input may end here, what is left is a valid padding
+  HUFFMAN_DECODE_FAIL   = 0x04, // EOS was decoded
+};
+
+struct HuffmanDecodeEntry {
+  uint8_t state;
+  uint8_t flags;
+  uint8_t symbol;
+};
+
+static const int HUFFMAN_DECODE_STATES = 256; // Internal nodes of a tree with 257 leaves
+static const uint16_t HUFFMAN_EOS      = 256;
+
+static HuffmanDecodeEntry (*huffman_decode_table)[16];
 
 static Node *
 make_huffman_tree_node()
 {
-  Node *n       = static_cast<Node *>(ats_malloc(sizeof(Node)));
-  n->left       = nullptr;
-  n->right      = nullptr;
-  n->ascii_code = '\0';
-  n->leaf_node  = false;
+  Node *n      = static_cast<Node *>(ats_malloc(sizeof(Node)));
+  n->left      = nullptr;
+  n->right     = nullptr;
+  n->symbol    = 0;
+  n->state     = 0;
+  n->leaf_node = false;
   return n;
 }
 
@@ -113,8 +136,8 @@ make_huffman_tree()
       }
       bit_len--;
     }
-    current->ascii_code = i;
-    current->leaf_node  = true;
+    current->symbol    = i;
+    current->leaf_node = true;
   }
   return root;
 }
@@ -132,62 +155,110 @@ free_huffman_tree(Node *node)
   ats_free(node);
 }
 
+// Number the internal nodes, and note which of them may end the input: those reached through at
+// most 7 one bits, the prefix of EOS used as padding.
+static void
+number_huffman_tree(Node *node, Node **states, int &n_states, bool *accept, int depth, bool all_ones)
+{
+  if (node->leaf_node) {
+    return;
+  }
+  node->state        = n_states;
+  states[n_states]   = node;
+  accept[n_states++] = all_ones && depth <= 7;
+  number_huffman_tree(node->left, states, n_states, accept, depth + 1, false);
+  number_huffman_tree(node->right, states, n_states, accept, depth + 1, all_ones);
+}
+
+static void
+make_huffman_decode_table(Node *root)
+{
+  Node *states[HUFFMAN_DECODE_STATES];
+  bool accept[HUFFMAN_DECODE_STATES];
+  int n_states = 0;
+
+  number_huffman_tree(root, states, n_states, accept, 0, true);
+  ink_release_assert(n_states == HUFFMAN_DECODE_STATES);
+
+  huffman_decode_table = static_cast<HuffmanDecodeEntry(*)[16]>(ats_malloc(sizeof(HuffmanDecodeEntry[HUFFMAN_DECODE_STATES][16])));
+  for (int state = 0; state < HUFFMAN_DECODE_STATES; ++state) {
+    for (int nibble = 0; nibble < 16; ++nibble) {
+      HuffmanDecodeEntry &entry = huffman_decode_table[state][nibble];
+      Node *current             = states[state];
+
+      entry.flags  = 0;
+      entry.symbol = 0;
+      for (int bit = 3; bit >= 0; --bit) {
+        current = (nibble & (1 << bit)) ? current->right : current->left;
+        if (current->leaf_node) {
+          if (current->symbol == HUFFMAN_EOS) {
+            entry.flags |= HUFFMAN_DECODE_FAIL;
+            break;
+          }
+          entry.flags |= HUFFMAN_DECODE_EMIT;
+          entry.symbol = current->symbol;
+          current      = root;
+        }
+      }
+      if (!(entry.flags & HUFFMAN_DECODE_FAIL)) {
+        entry.state = current->state;
+        if (accept[current->state]) {
+          entry.flags |= HUFFMAN_DECODE_ACCEPT;
+        }
+      } else {
+        entry.state = 0;
+      }
+    }
+  }
+}
+
 void
 hpack_huffman_init()
 {
-  if (!HUFFMAN_TREE_ROOT) {
-    HUFFMAN_TREE_ROOT = make_huffman_tree();
+  if (!huffman_decode_table) {
+    Node *root = make_huffman_tree();
+    make_huffman_decode_table(root);
+    free_huffman_tree(root);
   }
 }
 
 void
 hpack_huffman_fin()
 {
-  if (HUFFMAN_TREE_ROOT) {
-    free_huffman_tree(HUFFMAN_TREE_ROOT);
-  }
+  ats_free(huffman_decode_table);
+  huffman_decode_table = nullptr;
 }
 
 int64_t
 huffman_decode(char *dst_start, const uint8_t *src, uint32_t src_len)
 {
-  char *dst_end             = dst_start;
-  uint8_t shift             = 7;
-  Node *current             = HUFFMAN_TREE_ROOT;
-  int byte_boundary_crossed = 0;
-  bool includes_zero        = false;
-
-  while (src_len) {
-    if (*src & (1 << shift)) {
-      current = current->right;
-    } else {
-      current       = current->left;
-      includes_zero = true;
-    }
+  char *dst_end = dst_start;
+  uint8_t state = 0;
+  bool accept   = true;
 
-    if (current->leaf_node == true) {
-      *dst_end = current->ascii_code;
-      ++dst_end;
-      current               = HUFFMAN_TREE_ROOT;
-      byte_boundary_crossed = 0;
-      includes_zero         = false;
+  for (const uint8_t *end = src + src_len; src < end; ++src) {
+    const HuffmanDecodeEntry &high = huffman_decode_table[state][*src >> 4];
+    if (high.flags & HUFFMAN_DECODE_FAIL) {
+      return -1;
     }
-    if (shift) {
-      --shift;
-    } else {
-      shift = 7;
-      ++src;
-      --src_len;
-      ++byte_boundary_crossed;
+    if (high.flags & HUFFMAN_DECODE_EMIT) {
+      *dst_end++ = high.symbol;
     }
-    if (byte_boundary_crossed > 3) {
+
+    const HuffmanDecodeEntry &low = huffman_decode_table[high.state][*src & 0x0f];
+    if (low.flags & HUFFMAN_DECODE_FAIL) {
       return -1;
     }
+    if (low.flags & HUFFMAN_DECODE_EMIT) {
+      *dst_end++ = low.symbol;
+    }
+    state  = low.state;
+    accept = low.flags & HUFFMAN_DECODE_ACCEPT;
   }
-  if (byte_boundary_crossed > 1) {
-    return -1;
-  }
-  if (includes_zero) {
+
+  // [RFC 7541] 5.2. Padding longer than 7 bits, or not made of the most significant bits of EOS,
+  // is a decoding error.
+  if (!accept) {
     return -1;
   }
 
@@ -207,37 +278,40 @@ int64_t
 huffman_encode(uint8_t *dst_start, const uint8_t *src, uint32_t src_len)
 {
   uint8_t *dst = dst_start;
-  // NOTE: The maximum length of Huffman Code is 30, thus using uint32_t as buffer.
-  uint32_t buf         = 0;
-  uint32_t remain_bits = 32;
+  // NOTE: The maximum length of Huffman Code is 30, there is always room for one more in the
+  // 64 bit buffer after it is flushed down to less than 32 bits.
+  uint64_t buf  = 0;
+  uint32_t bits = 0;
 
   for (uint32_t i = 0; i < src_len; ++i) {
-    const uint32_t hex     = huffman_table[src[i]].code_as_hex;
-    const uint32_t bit_len = huffman_table[src[i]].bit_len;
-
-    if (remain_bits > bit_len) {
-      remain_bits = remain_bits - bit_len;
-      buf |= hex << remain_bits;
-    } else if (remain_bits == bit_len) {
-      buf |= hex;
-      dst         = huffman_encode_append(dst, buf);
-      remain_bits = 32;
-      buf         = 0;
-    } else {
-      buf |= hex >> (bit_len - remain_bits);
-      dst         = huffman_encode_append(dst, buf);
-      remain_bits = (32 - (bit_len - remain_bits));
-      buf         = hex << remain_bits;
+    buf = (buf << huffman_table[src[i]].bit_len) | huffman_table[src[i]].code_as_hex;
+    bits += huffman_table[src[i]].bit_len;
+    if (bits >= 32) {
+      bits -= 32;
+      dst = huffman_encode_append(dst, static_cast<uint32_t>(buf >> bits));
     }
   }
 
-  dst = huffman_encode_append(dst, buf, remain_bits / 8);
-
   // NOTE: Add padding w/ EOS
-  uint32_t pad_len = remain_bits % 8;
-  if (pad_len) {
-    *(dst - 1) |= 0xff >> (8 - pad_len);
+  const uint32_t pad_len = (8 - bits % 8) % 8;
+  buf                    = (buf << pad_len) | ((1 << pad_len) - 1);
+  bits += pad_len;
+  for (; bits; bits -= 8) {
+    *dst++ = buf >> (bits - 8);
   }
 
   return dst - dst_start;
 }
+
+// Number of octets huffman_encode() writes for @a src, including the EOS padding.
+int64_t
+huffman_encode_length(const uint8_t *src, uint32_t src_len)
+{
+  uint64_t bits = 0;
+
+  for (uint32_t i = 0; i < src_len; ++i) {
+    bits += huffman_table[src[i]].bit_len;
+  }
+
+  return (bits + 7) / 8;
+}
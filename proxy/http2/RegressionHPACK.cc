@@ -449,6 +449,44 @@ REGRESSION_TEST(HPACK_Encode)(RegressionTest *t, int, int *pstatus)
   }
 }
 
+REGRESSION_TEST(HPACK_DynamicTableLookup)(RegressionTest *t, int, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  HpackIndexingTable indexing_table(4096);
+  HpackLookupResult result;
+  char value[16];
+
+  // Enough entries to grow the ring and its hash index a few times, then evict the first ones.
+  for (int i = 0; i < 200; ++i) {
+    snprintf(value, sizeof(value), "value-%03d", i);
+    HTTPHdr headers;
+    headers.create(HTTP_TYPE_RESPONSE);
+    MIMEField *field = headers.field_create("x-custom", 8);
+    field->value_set(headers.m_heap, headers.m_mime, value, strlen(value));
+    indexing_table.add_header_field(field);
+    headers.destroy();
+    if (i == 0) {
+      result = indexing_table.lookup("X-Custom", 8, "value-000", 9);
+      box.check(result.match_type == HpackMatch::EXACT && result.index == 62, "first entry not found");
+    }
+  }
+
+  result = indexing_table.lookup("x-custom", 8, "value-199", 9);
+  box.check(result.match_type == HpackMatch::EXACT && result.index == 62, "newest entry is at index %d", result.index);
+  result = indexing_table.lookup("x-custom", 8, "value-150", 9);
+  box.check(result.match_type == HpackMatch::EXACT && result.index == 62 + 49, "older entry is at index %d", result.index);
+  result = indexing_table.lookup("x-custom", 8, "value-000", 9);
+  box.check(result.match_type == HpackMatch::NAME && result.index == 62, "evicted entry matched %d", result.index);
+  result = indexing_table.lookup(":status", 7, "304", 3);
+  box.check(result.match_type == HpackMatch::EXACT && result.index_type == HpackIndex::STATIC && result.index == 11,
+            "static entry is at index %d", result.index);
+  result = indexing_table.lookup("Content-Type", 12, "text/html", 9);
+  box.check(result.match_type == HpackMatch::NAME && result.index_type == HpackIndex::STATIC && result.index == 31,
+            "static name is at index %d", result.index);
+}
+
 REGRESSION_TEST(HPACK_DecodeInteger)(RegressionTest *t, int, int *pstatus)
 {
   TestBox box(t, pstatus);
@@ -29,7 +29,9 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <vector>
 #include "ts/ink_args.h"
+#include "ts/ink_hrtime.h"
 #include "ts/TestBox.h"
 
 const static int MAX_REQUEST_HEADER_SIZE = 131072;
@@ -40,6 +42,7 @@ using namespace std;
 AppVersionInfo appVersionInfo;
 
 static int cmd_disable_freelist = 0;
+static int cmd_benchmark        = 0;
 static char cmd_input_dir[512]  = "";
 static char cmd_output_dir[512] = "";
 
@@ -47,6 +50,8 @@ static const ArgumentDescription argument_descriptions[] = {
   {"disable_freelist", 'f', "Disable the freelist memory allocator", "T", &cmd_disable_freelist, nullptr, nullptr},
   {"input_dir", 'i', "input dir", "S511", &cmd_input_dir, nullptr, nullptr},
   {"output_dir", 'o', "output dir", "S511", &cmd_output_dir, nullptr, nullptr},
+  {"benchmark", 'b', "Encode and decode every story this many times and report the throughput", "I", &cmd_benchmark, nullptr,
+   nullptr},
   HELP_ARGUMENT_DESCRIPTION(),
   VERSION_ARGUMENT_DESCRIPTION()};
 
@@ -353,6 +358,107 @@ prepare()
   return 0;
 }
 
+// A story loaded in memory, the headers of each case and the wire format some other encoder produced for them.
+struct BenchmarkStory {
+  vector<HTTPHdr *> headers;
+  vector<string> wires;
+};
+
+static void
+load_story(const string &filename, BenchmarkStory &story)
+{
+  string line, name, value;
+  uint8_t unpacked[8192];
+  HTTPHdr *hdr = nullptr;
+  MIMEField *field;
+
+  ifstream ifs(filename);
+  while (ifs && getline(ifs, line)) {
+    switch (line.find_first_of('"')) {
+    case 6:
+      if (line[6 + 1] == 's') {
+        hdr = new HTTPHdr;
+        hdr->create(HTTP_TYPE_REQUEST);
+        story.headers.push_back(hdr);
+      } else if (line[6 + 1] == 'w') {
+        parse_line(line, 6, name, value);
+        story.wires.push_back(string(reinterpret_cast<char *>(unpacked), unpack(value, unpacked)));
+      }
+      break;
+    case 10:
+      if (hdr) {
+        parse_line(line, 10, name, value);
+        field = hdr->field_create(name.c_str(), name.length());
+        field->value_set(hdr->m_heap, hdr->m_mime, value.c_str(), value.length());
+        hdr->field_attach(field);
+      }
+      break;
+    }
+  }
+}
+
+// Times the decoder against the wire blocks of the stories and the encoder against their headers, each story starting
+// from an empty dynamic table as a new connection would.
+static void
+benchmark(int rounds)
+{
+  vector<BenchmarkStory> stories(last - first);
+  uint8_t encoded[8192];
+  uint64_t blocks = 0, bytes = 0;
+  HTTPHdr decoded;
+  ink_hrtime start;
+
+  for (int i = first; i < last; ++i) {
+    filename_in[offset_in + 0] = '0' + i / 10;
+    filename_in[offset_in + 1] = '0' + i % 10;
+    load_story(filename_in, stories[i - first]);
+  }
+
+  decoded.create(HTTP_TYPE_REQUEST);
+  start = ink_get_hrtime_internal();
+  for (int r = 0; r < rounds; ++r) {
+    for (const auto &story : stories) {
+      HpackIndexingTable indexing_table(INITIAL_TABLE_SIZE);
+      for (const auto &wire : story.wires) {
+        decoded.fields_clear();
+        hpack_decode_header_block(indexing_table, &decoded, reinterpret_cast<const uint8_t *>(wire.data()), wire.length(),
+                                  MAX_REQUEST_HEADER_SIZE, MAX_TABLE_SIZE);
+        bytes += wire.length();
+        ++blocks;
+      }
+    }
+  }
+  ink_hrtime elapsed = ink_get_hrtime_internal() - start;
+  decoded.destroy();
+  printf("decode: %" PRIu64 " header blocks, %" PRIu64 " bytes in %.3f s, %.0f blocks/s\n", blocks, bytes,
+         static_cast<double>(elapsed) / HRTIME_SECOND, static_cast<double>(blocks) * HRTIME_SECOND / (elapsed ? elapsed : 1));
+
+  blocks = bytes = 0;
+  start          = ink_get_hrtime_internal();
+  for (int r = 0; r < rounds; ++r) {
+    for (const auto &story : stories) {
+      HpackIndexingTable indexing_table(INITIAL_TABLE_SIZE);
+      for (const auto hdr : story.headers) {
+        int64_t written = hpack_encode_header_block(indexing_table, encoded, sizeof(encoded), hdr);
+        if (written > 0) {
+          bytes += written;
+        }
+        ++blocks;
+      }
+    }
+  }
+  elapsed = ink_get_hrtime_internal() - start;
+  printf("encode: %" PRIu64 " header blocks, %" PRIu64 " bytes in %.3f s, %.0f blocks/s\n", blocks, bytes,
+         static_cast<double>(elapsed) / HRTIME_SECOND, static_cast<double>(blocks) * HRTIME_SECOND / (elapsed ? elapsed : 1));
+
+  for (auto &story : stories) {
+    for (auto hdr : story.headers) {
+      hdr->destroy();
+      delete hdr;
+    }
+  }
+}
+
 REGRESSION_TEST(HPACK_Decoding)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
 {
   TestBox box(t, pstatus);
@@ -421,6 +527,11 @@ main(int argc, const char **argv)
   hpack_huffman_init();
 
   prepare();
+  if (cmd_benchmark > 0) {
+    benchmark(cmd_benchmark);
+    hpack_huffman_fin();
+    return 0;
+  }
   int status = RegressionTest::main(argc, argv, REGRESSION_TEST_QUICK);
 
   hpack_huffman_fin();
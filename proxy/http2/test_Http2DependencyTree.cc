@@ -24,8 +24,10 @@
 #include <iostream>
 #include <cstring>
 #include <sstream>
+#include <algorithm>
 
 #include "ts/TestBox.h"
+#include "ts/ink_hrtime.h"
 
 #include "Http2DependencyTree.h"
 
@@ -767,6 +769,140 @@ REGRESSION_TEST(Http2DependencyTree_max_depth)(RegressionTest *t, int /* atype A
   delete tree;
 }
 
+/**
+ * A stream that joins late starts at the virtual time of its parent
+ *
+ *   ROOT
+ *   /  \
+ *  A(1) B(3)
+ *
+ * A has been served alone for a while, B gets its share from when it joins, not the bandwidth A
+ * used before.
+ */
+REGRESSION_TEST(Http2DependencyTree_late_joiner)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  Tree *tree = new Tree(100);
+  string a("A"), b("B");
+
+  Node *node_a = tree->add(0, 1, 15, false, &a);
+  tree->activate(node_a);
+  for (int i = 0; i < 100; ++i) {
+    tree->update(tree->top(), 16384);
+  }
+
+  Node *node_b = tree->add(0, 3, 15, false, &b);
+  tree->activate(node_b);
+
+  ostringstream oss;
+  for (int i = 0; i < 8; ++i) {
+    Node *node = tree->top();
+    oss << static_cast<string *>(node->t)->c_str();
+    tree->update(node, 16384);
+  }
+
+  // Equal weights, equal shares
+  const string served = oss.str();
+  box.check(std::count(served.begin(), served.end(), 'A') == 4, "A and B should be served 4 times each: %s", served.c_str());
+
+  delete tree;
+}
+
+/**
+ * RFC 9218 Extensible Priorities
+ *
+ * The lowest urgency goes first, non-incremental streams of an urgency one after the other in
+ * stream identifier order and incremental ones take turns.
+ */
+REGRESSION_TEST(Http2DependencyTree_extensible)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  Tree *tree = new Tree(100, true);
+  string a("A"), b("B"), c("C"), d("D"), e("E");
+
+  Node *nodes[] = {
+    tree->add(1, 3, false, &a), tree->add(3, 3, false, &b), tree->add(5, 1, false, &c), tree->add(7, 5, true, &d),
+    tree->add(9, 5, true, &e),
+  };
+  for (Node *node : nodes) {
+    tree->activate(node);
+  }
+  box.check(tree->find(5) == nodes[2], "Node 5 should be found");
+
+  ostringstream oss;
+  for (int i = 0; i < 10; ++i) {
+    Node *node = tree->top();
+    oss << static_cast<string *>(node->t)->c_str();
+    // Every other turn the stream is done
+    if (i % 2 && !node->incremental) {
+      tree->deactivate(node, 100);
+      tree->remove(node);
+    } else {
+      tree->update(node, 100);
+    }
+  }
+  tree->set_urgency(nodes[4], 0, false);
+  oss << static_cast<string *>(tree->top()->t)->c_str();
+
+  const string expect = "CCAABBDEDEE";
+  box.check(oss.str() == expect, "\nExpect : %s\nActual : %s", expect.c_str(), oss.str().c_str());
+  box.check(tree->size() == 2, "Two streams should be left, not %u", tree->size());
+
+  delete tree;
+}
+
+/**
+ * 10,000 streams under the root and chained in branches of ten, with weights from 1 to 256. Times
+ * finding every stream and serving the active ones.
+ */
+REGRESSION_TEST(Http2DependencyTree_benchmark)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  const uint32_t n = 10000, rounds = 200000;
+  Tree *tree       = new Tree(n);
+  string a("A");
+
+  ink_hrtime start = ink_get_hrtime_internal();
+  for (uint32_t i = 0; i < n; ++i) {
+    uint32_t id = i * 2 + 1;
+    tree->add(i % 10 ? id - 2 : 0, id, i % 256, false, &a);
+  }
+  uint32_t found = 0;
+  for (uint32_t i = 0; i < n; ++i) {
+    found += tree->find(i * 2 + 1) != nullptr;
+  }
+  ink_hrtime elapsed = ink_get_hrtime_internal() - start;
+  rprintf(t, "add and find %u streams in %.3f s\n", n, static_cast<double>(elapsed) / HRTIME_SECOND);
+  box.check(found == n, "%u of %u streams found", found, n);
+
+  for (uint32_t i = 0; i < n; ++i) {
+    tree->activate(tree->find(i * 2 + 1));
+  }
+
+  uint32_t served = 0;
+  start           = ink_get_hrtime_internal();
+  for (uint32_t i = 0; i < rounds; ++i) {
+    Node *node = tree->top();
+    if (node == nullptr) {
+      break;
+    }
+    tree->update(node, 16384);
+    ++served;
+  }
+  elapsed = ink_get_hrtime_internal() - start;
+  rprintf(t, "%u frames on %u streams in %.3f s, %.0f frames/s\n", rounds, n, static_cast<double>(elapsed) / HRTIME_SECOND,
+          static_cast<double>(rounds) * HRTIME_SECOND / (elapsed ? elapsed : 1));
+  box.check(served == rounds, "%u of %u frames served", served, rounds);
+
+  delete tree;
+}
+
 int
 main(int /* argc ATS_UNUSED */, const char ** /* argv ATS_UNUSED */)
 {
@@ -0,0 +1,89 @@
+/** @file
+
+    Unit tests for Http2PushDiary
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <cstdio>
+#include <cstring>
+
+#include "ts/TestBox.h"
+
+#include "Http2PushDiary.h"
+
+static int
+url(char *buf, size_t size, const char *kind, int i)
+{
+  return snprintf(buf, size, "https://www.example.com/%s/%d.css", kind, i);
+}
+
+REGRESSION_TEST(Http2PushDiary_Basic)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  Http2PushDiary diary;
+  char buf[128];
+  int len;
+
+  len = url(buf, sizeof(buf), "held", 0);
+  box.check(!diary.contains(buf, len), "empty diary should not contain anything");
+
+  diary.add(buf, len);
+  box.check(!diary.contains(buf, len), "diary is off before init");
+
+  diary.init(256);
+  for (int i = 0; i < 256; ++i) {
+    len = url(buf, sizeof(buf), "held", i);
+    diary.add(buf, len);
+  }
+  for (int i = 0; i < 256; ++i) {
+    len = url(buf, sizeof(buf), "held", i);
+    box.check(diary.contains(buf, len), "%s should be in the diary", buf);
+  }
+
+  // 16 bits and 7 probes per URL give about 1 false positive in 2000
+  int false_positives = 0;
+  for (int i = 0; i < 100000; ++i) {
+    len = url(buf, sizeof(buf), "other", i);
+    false_positives += diary.contains(buf, len);
+  }
+  box.check(false_positives < 200, "%d false positives in 100000 lookups", false_positives);
+
+  // A full diary starts over
+  len = url(buf, sizeof(buf), "new", 0);
+  diary.add(buf, len);
+  box.check(diary.contains(buf, len), "%s should be in the diary", buf);
+  len = url(buf, sizeof(buf), "held", 0);
+  box.check(!diary.contains(buf, len), "%s should be gone from the full diary", buf);
+
+  diary.clear();
+  len = url(buf, sizeof(buf), "new", 0);
+  box.check(!diary.contains(buf, len), "cleared diary should not contain anything");
+}
+
+int
+main(int /* argc ATS_UNUSED */, const char ** /* argv ATS_UNUSED */)
+{
+  const char *name = "Http2PushDiary";
+  RegressionTest::run(name, REGRESSION_TEST_QUICK);
+
+  return RegressionTest::final_status == REGRESSION_TEST_PASSED ? 0 : 1;
+}
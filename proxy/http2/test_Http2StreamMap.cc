@@ -0,0 +1,196 @@
+/** @file
+
+    Unit tests for Http2StreamMap
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <cstdlib>
+
+#include "ts/TestBox.h"
+#include "ts/List.h"
+#include "ts/ink_hrtime.h"
+
+#include "Http2StreamMap.h"
+
+// Stands in for Http2Stream, on a list the way Http2ConnectionState keeps its streams.
+struct Stream {
+  Http2StreamId id;
+  LINK(Stream, link);
+};
+
+using Map = Http2StreamMap<Stream>;
+
+REGRESSION_TEST(Http2StreamMap_Basic)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  Map map;
+  Stream streams[200];
+
+  box.check(map.find(1) == nullptr, "empty map should not find anything");
+  box.check(!map.remove(1), "empty map should not remove anything");
+
+  for (int i = 0; i < 200; ++i) {
+    streams[i].id = i * 2 + 1;
+    map.insert(streams[i].id, &streams[i]);
+  }
+  box.check(map.size() == 200, "map should have 200 streams, not %u", map.size());
+  for (int i = 0; i < 200; ++i) {
+    box.check(map.find(streams[i].id) == &streams[i], "stream %u should be found", streams[i].id);
+  }
+  box.check(map.find(2) == nullptr, "stream 2 was never added");
+  box.check(map.find(401) == nullptr, "stream 401 was never added");
+
+  // Remove every third stream, the others must stay reachable across the shifted clusters.
+  for (int i = 0; i < 200; i += 3) {
+    box.check(map.remove(streams[i].id), "stream %u should be removed", streams[i].id);
+  }
+  box.check(!map.remove(streams[0].id), "stream 1 was already removed");
+  for (int i = 0; i < 200; ++i) {
+    box.check(map.find(streams[i].id) == (i % 3 ? &streams[i] : nullptr), "stream %u lookup after removals", streams[i].id);
+  }
+  box.check(map.size() == 133, "map should have 133 streams, not %u", map.size());
+}
+
+REGRESSION_TEST(Http2StreamMap_Random)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  const int n = 512;
+  Map map;
+  Stream streams[n];
+  bool open[n] = {false};
+
+  for (int i = 0; i < n; ++i) {
+    streams[i].id = i * 2 + 2;
+  }
+
+  // Random opens and closes checked against a plain array.
+  for (int round = 0; round < 100000; ++round) {
+    // coverity[dont_call]
+    int i = lrand48() % n;
+    if (open[i]) {
+      box.check(map.remove(streams[i].id), "stream %u should be removed", streams[i].id);
+    } else {
+      map.insert(streams[i].id, &streams[i]);
+    }
+    open[i] = !open[i];
+    // coverity[dont_call]
+    int j = lrand48() % n;
+    if (map.find(streams[j].id) != (open[j] ? &streams[j] : nullptr)) {
+      box.check(false, "stream %u lookup in round %d", streams[j].id, round);
+      break;
+    }
+  }
+}
+
+/**
+ * The frames of 1,000 concurrent streams, each frame looking its stream up, with streams closing
+ * and new ones opening as they would on a busy connection. The connection keeps its list either
+ * way, the map is timed against the linear walk of the list it replaces.
+ */
+REGRESSION_TEST(Http2StreamMap_Benchmark)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  const int concurrent = 1000, frames = 200000;
+  Stream *streams      = new Stream[concurrent];
+  Queue<Stream> stream_list;
+  Map map;
+  Http2StreamId next_id = 1;
+  int *slots            = new int[frames];
+  uint64_t found        = 0;
+
+  for (int i = 0; i < concurrent; ++i) {
+    streams[i].id = next_id;
+    next_id += 2;
+  }
+  for (int i = 0; i < frames; ++i) {
+    // coverity[dont_call]
+    slots[i] = lrand48() % concurrent;
+  }
+
+  for (int pass = 0; pass < 2; ++pass) {
+    const bool use_map = pass == 1;
+    ink_hrtime start   = ink_get_hrtime_internal();
+
+    for (int i = 0; i < concurrent; ++i) {
+      stream_list.enqueue(&streams[i]);
+      if (use_map) {
+        map.insert(streams[i].id, &streams[i]);
+      }
+    }
+    for (int i = 0; i < frames; ++i) {
+      Stream *s        = nullptr;
+      Http2StreamId id = streams[slots[i]].id;
+
+      if (use_map) {
+        s = map.find(id);
+      } else {
+        for (s = stream_list.head; s && s->id != id; s = s->link.next) {
+          ;
+        }
+      }
+      found += s != nullptr;
+
+      // Every 10th frame ends its stream and the client opens a new one.
+      if (i % 10 == 0) {
+        stream_list.remove(s);
+        if (use_map) {
+          map.remove(s->id);
+        }
+        s->id = next_id;
+        next_id += 2;
+        stream_list.enqueue(s);
+        if (use_map) {
+          map.insert(s->id, s);
+        }
+      }
+    }
+    for (int i = 0; i < concurrent; ++i) {
+      stream_list.remove(&streams[i]);
+      if (use_map) {
+        map.remove(streams[i].id);
+      }
+    }
+
+    ink_hrtime elapsed = ink_get_hrtime_internal() - start;
+    rprintf(t, "%s: %d frames on %d streams in %.3f s, %.0f frames/s\n", use_map ? "stream map" : "stream list", frames, concurrent,
+            static_cast<double>(elapsed) / HRTIME_SECOND, static_cast<double>(frames) * HRTIME_SECOND / (elapsed ? elapsed : 1));
+  }
+
+  box.check(found == 2 * static_cast<uint64_t>(frames), "every frame should find its stream");
+  box.check(map.size() == 0, "map should be empty");
+
+  delete[] streams;
+  delete[] slots;
+}
+
+int
+main(int /* argc ATS_UNUSED */, const char ** /* argv ATS_UNUSED */)
+{
+  const char *name = "Http2StreamMap";
+  RegressionTest::run(name, REGRESSION_TEST_QUICK);
+
+  return RegressionTest::final_status == REGRESSION_TEST_PASSED ? 0 : 1;
+}
@@ -22,6 +22,7 @@
 */
 
 #include "HuffmanCodec.h"
+#include "ts/ink_hrtime.h"
 #include <cstdlib>
 #include <iostream>
 #include <cassert>
@@ -64,6 +65,83 @@ uint32_t test_values[] = {
   0x7ffffeb,  27, 0xffffffe, 28, 0x7ffffec,  27, 0x7ffffed, 27, 0x7ffffee, 27, 0x7ffffef,  27, 0x7fffff0,  27, 0x3ffffee, 26,
   0x3fffffff, 30};
 
+// The bit at a time tree walk that huffman_decode() was before it became table driven. It is the
+// reference the fuzz test checks the decoder against, and the baseline of the benchmark.
+struct ReferenceNode {
+  ReferenceNode *child[2];
+  int symbol;
+};
+
+static ReferenceNode *reference_root;
+
+static ReferenceNode *
+reference_node()
+{
+  ReferenceNode *n = static_cast<ReferenceNode *>(calloc(1, sizeof(ReferenceNode)));
+  n->symbol        = -1;
+  return n;
+}
+
+void
+reference_init()
+{
+  reference_root = reference_node();
+  for (int symbol = 0; symbol < 257; ++symbol) {
+    const uint32_t code = test_values[symbol * 2];
+    ReferenceNode *n    = reference_root;
+    for (int bit = test_values[symbol * 2 + 1] - 1; bit >= 0; --bit) {
+      ReferenceNode *&child = n->child[(code >> bit) & 1];
+      if (!child) {
+        child = reference_node();
+      }
+      n = child;
+    }
+    n->symbol = symbol;
+  }
+}
+
+void
+reference_free(ReferenceNode *n)
+{
+  if (n) {
+    reference_free(n->child[0]);
+    reference_free(n->child[1]);
+    free(n);
+  }
+}
+
+int64_t
+reference_decode(char *dst_start, const uint8_t *src, uint32_t src_len)
+{
+  char *dst         = dst_start;
+  ReferenceNode *n  = reference_root;
+  int pending_bits  = 0;
+  bool pending_ones = true;
+
+  for (uint32_t i = 0; i < src_len; ++i) {
+    for (int shift = 7; shift >= 0; --shift) {
+      const int bit = (src[i] >> shift) & 1;
+      n             = n->child[bit];
+      ++pending_bits;
+      pending_ones = pending_ones && bit;
+      if (n->symbol >= 0) {
+        if (n->symbol == 256) {
+          return -1; // EOS
+        }
+        *dst++       = n->symbol;
+        n            = reference_root;
+        pending_bits = 0;
+        pending_ones = true;
+      }
+    }
+  }
+  if (pending_bits > 7 || !pending_ones) {
+    return -1;
+  }
+
+  return dst - dst_start;
+}
+
 void
 random_test()
 {
@@ -134,7 +212,12 @@ values_test()
     encoded_mapped.y[2] = encoded.y[1];
     encoded_mapped.y[3] = encoded.y[0];
 
-    int bytes        = huffman_decode(dst_start, encoded_mapped.y, encoded_size);
+    int bytes = huffman_decode(dst_start, encoded_mapped.y, encoded_size);
+    if (i / 2 == 256) {
+      // [RFC 7541] 5.2. A Huffman-encoded string literal containing the EOS symbol MUST be treated as a decoding error.
+      assert(bytes == -1);
+      continue;
+    }
     char ascii_value = i / 2;
     assert(dst_start[0] == ascii_value);
     assert(bytes == 1);
@@ -171,16 +254,118 @@ encode_test()
   }
 }
 
+// Round trips random strings, and checks the decoder against the reference on random and on
+// corrupted input, where most strings are invalid.
+void
+fuzz_test()
+{
+  uint8_t src[512], encoded[2048];
+  char decoded[4096], expected[4096];
+
+  for (int i = 0; i < 20000; i++) {
+    // coverity[dont_call]
+    const uint32_t src_len = lrand48() % 256;
+    for (uint32_t j = 0; j < src_len; ++j) {
+      // coverity[dont_call]
+      src[j] = (i & 1) ? lrand48() : ' ' + lrand48() % 95;
+    }
+
+    int64_t encoded_len = huffman_encode(encoded, src, src_len);
+    assert(encoded_len == huffman_encode_length(src, src_len));
+    assert(huffman_decode(decoded, encoded, encoded_len) == src_len);
+    assert(memcmp(decoded, src, src_len) == 0);
+
+    if (encoded_len && (i & 2)) {
+      // coverity[dont_call]
+      encoded[lrand48() % encoded_len] ^= 1 << (lrand48() % 8);
+    } else {
+      for (int64_t j = 0; j < encoded_len; ++j) {
+        // coverity[dont_call]
+        encoded[j] = lrand48();
+      }
+    }
+    if (i & 4) {
+      // coverity[dont_call]
+      encoded_len -= encoded_len ? lrand48() % (encoded_len > 4 ? 4 : encoded_len) : 0;
+    }
+
+    int64_t expected_len = reference_decode(expected, encoded, encoded_len);
+    int64_t decoded_len  = huffman_decode(decoded, encoded, encoded_len);
+    assert(decoded_len == expected_len);
+    assert(decoded_len < 0 || memcmp(decoded, expected, decoded_len) == 0);
+  }
+}
+
+void
+print_rate(const char *what, double bytes, ink_hrtime start)
+{
+  cout << what << bytes * HRTIME_SECOND / (ink_get_hrtime_internal() - start) / (1 << 20) << " MB/s" << endl;
+}
+
+// Throughput of the encoder, and of the decoder against the reference, on 1MB of printable strings
+// that average the size of a cookie.
+void
+benchmark()
+{
+  const int rounds = 20, size = 1 << 20, string_len = 64;
+  uint8_t *src     = static_cast<uint8_t *>(malloc(size));
+  uint8_t *encoded = static_cast<uint8_t *>(malloc(size * 4));
+  char *decoded    = static_cast<char *>(malloc(size));
+  int64_t encoded_len[size / string_len];
+  ink_hrtime start;
+
+  for (int i = 0; i < size; ++i) {
+    // coverity[dont_call]
+    src[i] = ' ' + lrand48() % 95;
+  }
+
+  start = ink_get_hrtime_internal();
+  for (int r = 0; r < rounds; ++r) {
+    for (int i = 0; i < size / string_len; ++i) {
+      encoded_len[i] = huffman_encode(encoded + i * string_len * 4, src + i * string_len, string_len);
+    }
+  }
+  print_rate("encode:           ", static_cast<double>(rounds) * size, start);
+
+  start = ink_get_hrtime_internal();
+  for (int r = 0; r < rounds; ++r) {
+    for (int i = 0; i < size / string_len; ++i) {
+      huffman_decode(decoded + i * string_len, encoded + i * string_len * 4, encoded_len[i]);
+    }
+  }
+  print_rate("decode:           ", static_cast<double>(rounds) * size, start);
+  assert(memcmp(decoded, src, size) == 0);
+
+  start = ink_get_hrtime_internal();
+  for (int r = 0; r < rounds; ++r) {
+    for (int i = 0; i < size / string_len; ++i) {
+      reference_decode(decoded + i * string_len, encoded + i * string_len * 4, encoded_len[i]);
+    }
+  }
+  print_rate("reference decode: ", static_cast<double>(rounds) * size, start);
+
+  free(src);
+  free(encoded);
+  free(decoded);
+}
+
 int
-main()
+main(int argc, char *argv[])
 {
   hpack_huffman_init();
+  reference_init();
 
-  for (int i = 0; i < 100; i++) {
-    random_test();
+  if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+    benchmark();
+  } else {
+    for (int i = 0; i < 100; i++) {
+      random_test();
+    }
+    values_test();
+    fuzz_test();
   }
-  values_test();
 
+  reference_free(reference_root);
   hpack_huffman_fin();
 
   encode_test();
@@ -0,0 +1,85 @@
+'''
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+from hyper import HTTPConnection
+import hyper
+import argparse
+
+
+def connect(port):
+    return HTTPConnection('localhost:{0}'.format(port), secure=True)
+
+
+def makerequest(port, url, close_connection):
+    hyper.tls._context = hyper.tls.init_context()
+    hyper.tls._context.check_hostname = False
+    hyper.tls._context.verify_mode = hyper.compat.ssl.CERT_NONE
+
+    conn = connect(port)
+
+    # Walk away from the first response part way through, either with a
+    # RST_STREAM or by dropping the connection
+    request_id = conn.request('GET', url=url)
+    response = conn.get_response(request_id)
+    response.read(1024)
+    if close_connection:
+        conn.close()
+        conn = connect(port)
+    else:
+        response.close()
+
+    # The next transaction has to come back whole
+    request_id = conn.request('GET', url=url)
+    response = conn.get_response(request_id)
+    body = response.read()
+    cl = response.headers.get('Content-Length')[0]
+    print("Content length = {}\r\n".format(int(cl)))
+    print("Body length = {}\r\n".format(len(body)))
+    error = 0
+    if chr(body[0]) != 'a':
+        error = 1
+        print("First char {}".format(body[0]))
+    i = 1
+    while i < len(body) and not error:
+        error = chr(body[i]) != 'b'
+        if error:
+            print("bad char {} at {}".format(body[i], i))
+        i = i + 1
+    if not error:
+        print("Content success\r\n")
+    else:
+        print("Content fail\r\n")
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--port", "-p",
+                        type=int,
+                        help="Port to use")
+    parser.add_argument("--url", "-u",
+                        type=str,
+                        help="url")
+    parser.add_argument("--close", "-c",
+                        action='store_true',
+                        help="Close the connection instead of resetting the stream")
+    args = parser.parse_args()
+    makerequest(args.port, args.url, args.close)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,117 @@
+'''
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+Test.Summary = '''
+Test HTTP/2 transactions that run on another thread than their session
+'''
+# need Curl
+Test.SkipUnless(
+    Condition.HasProgram("curl", "Curl need to be installed on system for this test to work"),
+    Condition.HasCurlFeature('http2')
+)
+Test.ContinueOnFail = True
+# Define default ATS
+ts = Test.MakeATSProcess("ts", select_ports=False)
+server = Test.MakeOriginServer("server")
+
+request_header = {"headers": "GET / HTTP/1.1\r\nHost: www.example.com\r\n\r\n", "timestamp": "1469733493.993", "body": ""}
+response_header = {"headers": "HTTP/1.1 200 OK\r\nServer: microserver\r\nConnection: close\r\n\r\n",
+                   "timestamp": "1469733493.993", "body": ""}
+server.addResponse("sessionlog.json", request_header, response_header)
+
+server.addResponse("sessionlog.json",
+                   {"headers": "GET /bigfile HTTP/1.1\r\nHost: www.example.com\r\n\r\n", "timestamp": "1469733493.993", "body": ""},
+                   {"headers": "HTTP/1.1 200 OK\r\nServer: microserver\r\nConnection: close\r\nCache-Control: max-age=3600\r\nContent-Length: 191414\r\n\r\n", "timestamp": "1469733493.993", "body": ""})
+
+# Not cached, so that every transaction is still reading from the origin when the client walks away
+server.addResponse("sessionlog.json",
+                   {"headers": "GET /resetfile HTTP/1.1\r\nHost: www.example.com\r\n\r\n", "timestamp": "1469733493.993", "body": ""},
+                   {"headers": "HTTP/1.1 200 OK\r\nServer: microserver\r\nConnection: close\r\nCache-Control: no-store\r\nContent-Length: 1048576\r\n\r\n", "timestamp": "1469733493.993", "body": ""})
+
+server.addResponse("sessionlog.json",
+                   {"headers": "GET /chunked HTTP/1.1\r\nHost: www.example.com\r\n\r\n", "timestamp": "1469733493.993", "body": ""},
+                   {"headers": "HTTP/1.1 200 OK\r\nServer: microserver\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n", "timestamp": "1469733493.993", "body": ""})
+# add ssl materials like key, certificates for the server
+ts.addSSLfile("ssl/server.pem")
+ts.addSSLfile("ssl/server.key")
+
+ts.Variables.ssl_port = 4443
+ts.Disk.remap_config.AddLine(
+    'map / http://127.0.0.1:{0}'.format(server.Variables.Port)
+)
+
+ts.Disk.ssl_multicert_config.AddLine(
+    'dest_ip=* ssl_cert_name=server.pem ssl_key_name=server.key'
+)
+ts.Disk.records_config.update({
+    'proxy.config.diags.debug.enabled': 1,
+    'proxy.config.diags.debug.tags': 'http2_stream',
+    'proxy.config.ssl.server.cert.path': '{0}'.format(ts.Variables.SSLDir),
+    'proxy.config.ssl.server.private_key.path': '{0}'.format(ts.Variables.SSLDir),
+    'proxy.config.http.server_ports': '{0} {1}:proto=http2;http:ssl'.format(ts.Variables.port, ts.Variables.ssl_port),
+    'proxy.config.ssl.client.verify.server':  0,
+    # More than one net thread for the transactions to go to
+    'proxy.config.exec_thread.autoconfig': 0,
+    'proxy.config.exec_thread.limit': 4,
+    'proxy.config.http2.distribute_transactions': 1,
+})
+ts.Streams.All = Testers.ContainsExpression("runs its transaction on another thread",
+                                            "The transactions should run apart from their sessions")
+ts.Setup.CopyAs('h2client.py', Test.RunDirectory)
+ts.Setup.CopyAs('h2bigclient.py', Test.RunDirectory)
+ts.Setup.CopyAs('h2chunked.py', Test.RunDirectory)
+ts.Setup.CopyAs('h2reset.py', Test.RunDirectory)
+
+# Test Case 1: The transaction starts on another thread and its response headers make it back
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = 'python3 h2client.py -p {0}'.format(ts.Variables.ssl_port)
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.StartBefore(server)
+tr.Processes.Default.StartBefore(Test.Processes.ts, ready=When.PortOpen(ts.Variables.ssl_port))
+tr.Processes.Default.Streams.stdout = "gold/remap-200.gold"
+tr.StillRunningAfter = server
+
+# Test Case 2: The body is relayed whole, for two streams on one session
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = 'python3 h2bigclient.py -p {0}'.format(ts.Variables.ssl_port)
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = "gold/bigfile.gold"
+tr.StillRunningAfter = server
+
+# Test Case 3: Chunked content, with the stream closed after the last chunk
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = 'python3 h2chunked.py -p {0} -u /chunked'.format(ts.Variables.ssl_port)
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = "gold/chunked.gold"
+tr.StillRunningAfter = server
+
+# Test Case 4: The client resets the stream in the middle of the response
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = 'python3 h2reset.py -p {0} -u /resetfile'.format(ts.Variables.ssl_port)
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = "gold/reset.gold"
+tr.StillRunningAfter = server
+tr.StillRunningAfter = ts
+
+# Test Case 5: The client drops the connection in the middle of the response
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = 'python3 h2reset.py -p {0} -u /resetfile -c'.format(ts.Variables.ssl_port)
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = "gold/reset.gold"
+tr.StillRunningAfter = server
+tr.StillRunningAfter = ts